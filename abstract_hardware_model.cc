@@ -141,6 +141,7 @@ void warp_inst_t::set_active( const active_mask_t &active ) {
       for( unsigned i=0; i < m_config->warp_size; i++ ) {
          if( !m_warp_active_mask.test(i) ) {
              m_per_scalar_thread[i].callback.function = NULL;
+             m_per_scalar_thread[i].callback.warp_function = NULL;
              m_per_scalar_thread[i].callback.instruction = NULL;
              m_per_scalar_thread[i].callback.thread = NULL;
          }
@@ -155,6 +156,30 @@ void warp_inst_t::do_atomic(bool forceDo) {
 
 void warp_inst_t::do_atomic( const active_mask_t& access_mask,bool forceDo ) {
     assert( m_isatomic && (!m_empty||forceDo) );
+
+    // hand all lanes to the warp-level callback when every lane provides one,
+    // so lanes hitting the same address share a single read-modify-write
+    class ptx_thread_info *threads[MAX_WARP_SIZE];
+    unsigned nthreads = 0;
+    const dram_callback_t *first = NULL;
+    bool batch = true;
+    for( unsigned i=0; i < m_config->warp_size && batch; i++ ) {
+        if( access_mask.test(i) ) {
+            const dram_callback_t &cb = m_per_scalar_thread[i].callback;
+            if( !cb.thread )
+                continue;
+            if( first == NULL )
+                first = &cb;
+            batch = cb.warp_function != NULL && cb.warp_function == first->warp_function && 
+                    cb.instruction == first->instruction;
+            threads[nthreads++] = cb.thread;
+        }
+    }
+    if( first && batch ) {
+        first->warp_function(first->instruction, threads, nthreads);
+        return;
+    }
+
     for( unsigned i=0; i < m_config->warp_size; i++ )
     {
         if( access_mask.test(i) )
@@ -352,6 +377,126 @@ void warp_inst_t::generate_mem_accesses()
     m_mem_accesses_created=true;
 }
 
+// Scratch table used to group the lanes of one subwarp into memory
+// transactions. Transactions are kept in a flat array in the order they are
+// created. In the common unit-stride and broadcast patterns block addresses
+// arrive in non-decreasing order, so each lane either joins the newest block
+// or starts a new one and no lookup is needed. Other patterns fall back to a
+// small open-addressing index over the array, built the first time a lane
+// goes back to an earlier block. Transactions come out ordered by block
+// address and, within a block, by creation, as the std::map version did.
+struct warp_inst_t::transaction_table {
+    static const unsigned max_transactions = MAX_WARP_SIZE*MAX_ACCESSES_PER_INSN_PER_THREAD;
+    static const unsigned index_log2 = 9;
+    static const unsigned index_size = 1u<<index_log2;
+    typedef char index_covers_twice_the_transactions[index_size >= 2*max_transactions ? 1 : -1];
+
+    new_addr_type m_addr[max_transactions];
+    transaction_info m_info[max_transactions];
+    int m_next_in_block[max_transactions]; // next transaction with the same block address, -1 at the end
+    unsigned m_order[max_transactions];
+    unsigned m_n;
+    int m_last_block; // first transaction of the highest block while ascending
+    bool m_ascending;
+    bool m_indexed;
+    unsigned short m_index[index_size]; // 1 + first transaction of a block, 0 = empty
+
+    void clear()
+    {
+        if( m_indexed ) 
+            memset(m_index,0,sizeof(m_index));
+        m_n = 0;
+        m_last_block = -1;
+        m_ascending = true;
+        m_indexed = false;
+    }
+
+    // first transaction for block address addr, -1 if there is none yet
+    int find( new_addr_type addr )
+    {
+        if( m_ascending ) {
+            if( m_last_block < 0 || addr > m_addr[m_last_block] ) 
+                return -1;
+            if( addr == m_addr[m_last_block] ) 
+                return m_last_block;
+            m_ascending = false;
+        }
+        if( !m_indexed ) 
+            build_index();
+        unsigned h = hash(addr);
+        while( m_index[h] ) {
+            if( m_addr[m_index[h]-1] == addr ) 
+                return m_index[h]-1;
+            h = (h+1) & (index_size-1);
+        }
+        return -1;
+    }
+
+    // new empty transaction for addr, chained after first (-1 for a new block)
+    unsigned add( new_addr_type addr, int first )
+    {
+        assert( m_n < max_transactions );
+        unsigned t = m_n++;
+        m_addr[t] = addr;
+        m_info[t] = transaction_info();
+        m_next_in_block[t] = -1;
+        if( first >= 0 ) {
+            int last = first;
+            while( m_next_in_block[last] >= 0 ) 
+                last = m_next_in_block[last];
+            m_next_in_block[last] = t;
+        } else if( m_ascending ) {
+            m_last_block = t;
+        } else {
+            insert_index(t);
+        }
+        return t;
+    }
+
+    // fills m_order with the transactions in block address order
+    void sort()
+    {
+        for( unsigned t=0; t < m_n; t++ ) 
+            m_order[t] = t;
+        if( !m_ascending ) 
+            std::stable_sort(m_order, m_order+m_n, by_addr(m_addr));
+    }
+
+private:
+    struct by_addr {
+        const new_addr_type *m_addr;
+        by_addr( const new_addr_type *addr ) : m_addr(addr) {}
+        bool operator()( unsigned a, unsigned b ) const { return m_addr[a] < m_addr[b]; }
+    };
+
+    // keep the high bits of the product: block addresses are segment aligned,
+    // so the low bits of addr*2654435761u are always zero
+    static unsigned hash( new_addr_type addr ) { return ((unsigned)addr*2654435761u) >> (32-index_log2); }
+
+    void insert_index( unsigned t )
+    {
+        unsigned h = hash(m_addr[t]);
+        while( m_index[h] ) 
+            h = (h+1) & (index_size-1);
+        m_index[h] = t+1;
+    }
+
+    void build_index()
+    {
+        // transactions chained onto a block are never block heads
+        bool head[max_transactions];
+        for( unsigned t=0; t < m_n; t++ ) 
+            head[t] = true;
+        for( unsigned t=0; t < m_n; t++ ) 
+            if( m_next_in_block[t] >= 0 ) 
+                head[m_next_in_block[t]] = false;
+        for( unsigned t=0; t < m_n; t++ ) 
+            if( head[t] ) 
+                insert_index(t);
+        m_indexed = true;
+    }
+};
+
 void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type access_type )
 {
     // see the CUDA manual where it discusses coalescing rules before reading this
@@ -364,8 +509,9 @@ void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type acce
     }
     unsigned subwarp_size = m_config->warp_size / warp_parts;
 
+    static transaction_table subwarp_transactions;
     for( unsigned subwarp=0; subwarp <  warp_parts; subwarp++ ) {
-        std::map<new_addr_type,transaction_info> subwarp_transactions;
+        subwarp_transactions.clear();
 
         // step 1: find all transactions generated by this subwarp
         for( unsigned thread=subwarp*subwarp_size; thread<subwarp_size*(subwarp+1); thread++ ) {
@@ -391,7 +537,10 @@ void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type acce
                 new_addr_type addr = m_per_scalar_thread[thread].memreqaddr[access];
                 unsigned block_address = line_size_based_tag_func(addr,segment_size);
                 unsigned chunk = (addr&127)/32; // which 32-byte chunk within in a 128-byte chunk does this thread access?
-                transaction_info &info = subwarp_transactions[block_address];
+                int t = subwarp_transactions.find(block_address);
+                if( t < 0 ) 
+                    t = subwarp_transactions.add(block_address,-1);
+                transaction_info &info = subwarp_transactions.m_info[t];
 
                 // can only write to one segment
                 assert(block_address == line_size_based_tag_func(addr+data_size_coales-1,segment_size));
@@ -405,10 +554,11 @@ void warp_inst_t::memory_coalescing_arch_13( bool is_write, mem_access_type acce
         }
 
         // step 2: reduce each transaction size, if possible
-        std::map< new_addr_type, transaction_info >::iterator t;
-        for( t=subwarp_transactions.begin(); t !=subwarp_transactions.end(); t++ ) {
-            new_addr_type addr = t->first;
-            const transaction_info &info = t->second;
+        subwarp_transactions.sort();
+        for( unsigned i=0; i < subwarp_transactions.m_n; i++ ) {
+            unsigned t = subwarp_transactions.m_order[i];
+            new_addr_type addr = subwarp_transactions.m_addr[t];
+            const transaction_info &info = subwarp_transactions.m_info[t];
 
             memory_coalescing_arch_13_reduce_and_send(is_write, access_type, info, addr, segment_size);
 
@@ -431,8 +581,9 @@ void warp_inst_t::memory_coalescing_arch_13_atomic( bool is_write, mem_access_ty
    }
    unsigned subwarp_size = m_config->warp_size / warp_parts;
 
+   static transaction_table subwarp_transactions; // each block addr maps to a chain of transactions
    for( unsigned subwarp=0; subwarp <  warp_parts; subwarp++ ) {
-       std::map<new_addr_type,std::list<transaction_info> > subwarp_transactions; // each block addr maps to a list of transactions
+       subwarp_transactions.clear();
 
        // step 1: find all transactions generated by this subwarp
        for( unsigned thread=subwarp*subwarp_size; thread<subwarp_size*(subwarp+1); thread++ ) {
@@ -447,21 +598,18 @@ void warp_inst_t::memory_coalescing_arch_13_atomic( bool is_write, mem_access_ty
            assert(block_address == line_size_based_tag_func(addr+data_size-1,segment_size));
 
            // Find a transaction that does not conflict with this thread's accesses
-           bool new_transaction = true;
-           std::list<transaction_info>::iterator it;
-           transaction_info* info;
-           for(it=subwarp_transactions[block_address].begin(); it!=subwarp_transactions[block_address].end(); it++) {
+           int first = subwarp_transactions.find(block_address);
+           transaction_info* info = NULL;
+           for( int t=first; t >= 0; t=subwarp_transactions.m_next_in_block[t] ) {
               unsigned idx = (addr&127);
-              if(not it->test_bytes(idx,idx+data_size-1)) {
-                 new_transaction = false;
-                 info = &(*it);
+              if(not subwarp_transactions.m_info[t].test_bytes(idx,idx+data_size-1)) {
+                 info = &subwarp_transactions.m_info[t];
                  break;
               }
            }
-           if(new_transaction) {
+           if( info == NULL ) {
               // Need a new transaction
-              subwarp_transactions[block_address].push_back(transaction_info());
-              info = &subwarp_transactions[block_address].back();
+              info = &subwarp_transactions.m_info[subwarp_transactions.add(block_address,first)];
            }
            assert(info);
 
@@ -475,18 +623,13 @@ void warp_inst_t::memory_coalescing_arch_13_atomic( bool is_write, mem_access_ty
        }
 
        // step 2: reduce each transaction size, if possible
-       std::map< new_addr_type, std::list<transaction_info> >::iterator t_list;
-       for( t_list=subwarp_transactions.begin(); t_list !=subwarp_transactions.end(); t_list++ ) {
-           // For each block addr
-           new_addr_type addr = t_list->first;
-           const std::list<transaction_info>& transaction_list = t_list->second;
-
-           std::list<transaction_info>::const_iterator t;
-           for(t=transaction_list.begin(); t!=transaction_list.end(); t++) {
-               // For each transaction
-               const transaction_info &info = *t;
-               memory_coalescing_arch_13_reduce_and_send(is_write, access_type, info, addr, segment_size);
-           }
+       subwarp_transactions.sort();
+       for( unsigned i=0; i < subwarp_transactions.m_n; i++ ) {
+           // For each transaction, grouped by block addr
+           unsigned t = subwarp_transactions.m_order[i];
+           new_addr_type addr = subwarp_transactions.m_addr[t];
+           const transaction_info &info = subwarp_transactions.m_info[t];
+           memory_coalescing_arch_13_reduce_and_send(is_write, access_type, info, addr, segment_size);
        }
    }
 }
@@ -582,12 +725,15 @@ simt_stack::simt_stack( unsigned wid, unsigned warpSize)
 {
     m_warp_id=wid;
     m_warp_size = warpSize;
+    // every divergence turns the top entry into a reconvergence entry and adds
+    // at most two paths, and only a group of two or more threads can diverge
+    m_stack.resize(2*m_warp_size+2);
     reset();
 }
 
 void simt_stack::reset()
 {
-    m_stack.clear();
+    m_depth = 0;
 }
 
 void simt_stack::launch( address_type start_pc, const simt_mask_t &active_mask )
@@ -598,32 +744,29 @@ void simt_stack::launch( address_type start_pc, const simt_mask_t &active_mask )
     new_stack_entry.m_calldepth = 1;
     new_stack_entry.m_active_mask = active_mask;
     new_stack_entry.m_type = STACK_ENTRY_TYPE_NORMAL;
-    m_stack.push_back(new_stack_entry);
+    push(new_stack_entry);
 }
 
 const simt_mask_t &simt_stack::get_active_mask() const
 {
-    assert(m_stack.size() > 0);
-    return m_stack.back().m_active_mask;
+    return top().m_active_mask;
 }
 
 void simt_stack::get_pdom_stack_top_info( unsigned *pc, unsigned *rpc ) const
 {
-   assert(m_stack.size() > 0);
-   *pc = m_stack.back().m_pc;
-   *rpc = m_stack.back().m_recvg_pc;
+   *pc = top().m_pc;
+   *rpc = top().m_recvg_pc;
 }
 
 unsigned simt_stack::get_rp() const 
 { 
-    assert(m_stack.size() > 0);
-    return m_stack.back().m_recvg_pc;
+    return top().m_recvg_pc;
 }
 
 void simt_stack::print (FILE *fout) const
 {
-    for ( unsigned k=0; k < m_stack.size(); k++ ) {
-        simt_stack_entry stack_entry = m_stack[k];
+    for ( unsigned k=0; k < m_depth; k++ ) {
+        const simt_stack_entry &stack_entry = m_stack[k];
         if ( k==0 ) {
             fprintf(fout, "w%02d %1u ", m_warp_id, k );
         } else {
@@ -647,16 +790,35 @@ void simt_stack::print (FILE *fout) const
     }
 }
 
-void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op,unsigned next_inst_size, address_type next_inst_pc )
+// lanes of the warp whose next pc equals pc; written as a flat compare over
+// the lane array so the compiler can vectorize it
+static simt_mask_t lanes_with_next_pc( const addr_vector_t &next_pc, unsigned warp_size, address_type pc )
+{
+    unsigned long match = 0;
+    for (unsigned i = 0; i < warp_size; i++)
+        match |= (unsigned long)(next_pc[i] == pc) << i;
+    return simt_mask_t(match);
+}
+
+// next pc of the highest numbered thread in mask
+static address_type highest_lane_next_pc( const simt_mask_t &mask, const addr_vector_t &next_pc, unsigned warp_size )
 {
-    assert(m_stack.size() > 0);
+    for (int i = warp_size - 1; i >= 0; i--) {
+        if (mask.test(i))
+            return next_pc[i];
+    }
+    assert(0);
+    return -1;
+}
 
-    assert( next_pc.size() == m_warp_size );
+void simt_stack::update( simt_mask_t &thread_done, const addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op,unsigned next_inst_size, address_type next_inst_pc )
+{
+    assert(m_depth > 0);
 
-    simt_mask_t  top_active_mask = m_stack.back().m_active_mask;
-    address_type top_recvg_pc = m_stack.back().m_recvg_pc;
-    address_type top_pc = m_stack.back().m_pc; // the pc of the instruction just executed
-    stack_entry_type top_type = m_stack.back().m_type;
+    simt_mask_t  top_active_mask = top().m_active_mask;
+    address_type top_recvg_pc = top().m_recvg_pc;
+    address_type top_pc = top().m_pc; // the pc of the instruction just executed
+    stack_entry_type top_type = top().m_type;
     assert(top_pc==next_inst_pc);
     assert(top_active_mask.any());
 
@@ -665,54 +827,31 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
     address_type new_recvg_pc = null_pc;
     unsigned num_divergent_paths=0;
 
-    std::map<address_type,simt_mask_t> divergent_paths;
-    while (top_active_mask.any()) {
-
-        // extract a group of threads with the same next PC among the active threads in the warp
-        address_type tmp_next_pc = null_pc;
-        simt_mask_t tmp_active_mask;
-        for (int i = m_warp_size - 1; i >= 0; i--) {
-            if ( top_active_mask.test(i) ) { // is this thread active?
-                if (thread_done.test(i)) {
-                    top_active_mask.reset(i); // remove completed thread from active mask
-                } else if (tmp_next_pc == null_pc) {
-                    tmp_next_pc = next_pc[i];
-                    tmp_active_mask.set(i);
-                    top_active_mask.reset(i);
-                } else if (tmp_next_pc == next_pc[i]) {
-                    tmp_active_mask.set(i);
-                    top_active_mask.reset(i);
-                }
-            }
-        }
-
-        if(tmp_next_pc == null_pc) {
-            assert(!top_active_mask.any()); // all threads done
-            continue;
-        }
-
-        divergent_paths[tmp_next_pc]=tmp_active_mask;
+    // split the active threads that are not done into groups with the same
+    // next pc, starting with the highest numbered thread; at most two groups
+    address_type path_pc[2];
+    simt_mask_t path_mask[2];
+    simt_mask_t live_mask = top_active_mask & ~thread_done;
+    while (live_mask.any()) {
+        assert(num_divergent_paths < 2);
+        address_type pc = highest_lane_next_pc(live_mask, next_pc, m_warp_size);
+        path_pc[num_divergent_paths] = pc;
+        path_mask[num_divergent_paths] = live_mask & lanes_with_next_pc(next_pc, m_warp_size, pc);
+        live_mask &= ~path_mask[num_divergent_paths];
         num_divergent_paths++;
     }
 
-
+    // the not taken path is pushed first, otherwise paths go in pc order
     address_type not_taken_pc = next_inst_pc+next_inst_size;
-    assert(num_divergent_paths<=2);
+    if (num_divergent_paths == 2 && 
+        (path_pc[1] == not_taken_pc || (path_pc[0] != not_taken_pc && path_pc[1] < path_pc[0]))) {
+        std::swap(path_pc[0], path_pc[1]);
+        std::swap(path_mask[0], path_mask[1]);
+    }
+
     for(unsigned i=0; i<num_divergent_paths; i++){
-    	address_type tmp_next_pc = null_pc;
-    	simt_mask_t tmp_active_mask;
-    	tmp_active_mask.reset();
-    	if(divergent_paths.find(not_taken_pc)!=divergent_paths.end()){
-    		assert(i==0);
-    		tmp_next_pc=not_taken_pc;
-    		tmp_active_mask=divergent_paths[tmp_next_pc];
-    		divergent_paths.erase(tmp_next_pc);
-    	}else{
-    		std::map<address_type,simt_mask_t>:: iterator it=divergent_paths.begin();
-    		tmp_next_pc=it->first;
-    		tmp_active_mask=divergent_paths[tmp_next_pc];
-    		divergent_paths.erase(tmp_next_pc);
-    	}
+    	address_type tmp_next_pc = path_pc[i];
+    	simt_mask_t tmp_active_mask = path_mask[i];
 
         // HANDLE THE SPECIAL CASES FIRST
     	if (next_inst_op== CALL_OPS){
@@ -724,19 +863,19 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
     		new_stack_entry.m_active_mask = tmp_active_mask;
     		new_stack_entry.m_branch_div_cycle = gpu_sim_cycle+gpu_tot_sim_cycle;
     		new_stack_entry.m_type = STACK_ENTRY_TYPE_CALL;
-    		m_stack.push_back(new_stack_entry);
+    		push(new_stack_entry);
     		return;
     	}else if(next_inst_op == RET_OPS && top_type==STACK_ENTRY_TYPE_CALL){
     		// pop the CALL Entry
     		assert(num_divergent_paths == 1);
-    		m_stack.pop_back();
+    		pop();
 
-    		assert(m_stack.size() > 0);
-    		m_stack.back().m_pc=tmp_next_pc;// set the PC of the stack top entry to return PC from  the call stack;
+    		assert(m_depth > 0);
+    		top().m_pc=tmp_next_pc;// set the PC of the stack top entry to return PC from  the call stack;
             // Check if the New top of the stack is reconverging
-            if (tmp_next_pc == m_stack.back().m_recvg_pc && m_stack.back().m_type!=STACK_ENTRY_TYPE_CALL){
-            	assert(m_stack.back().m_type==STACK_ENTRY_TYPE_NORMAL);
-            	m_stack.pop_back();
+            if (tmp_next_pc == top().m_recvg_pc && top().m_type!=STACK_ENTRY_TYPE_CALL){
+            	assert(top().m_type==STACK_ENTRY_TYPE_NORMAL);
+            	pop();
             }
             return;
     	}
@@ -753,10 +892,10 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
             // modify the existing top entry into a reconvergence entry in the pdom stack
             new_recvg_pc = recvg_pc;
             if (new_recvg_pc != top_recvg_pc) {
-                m_stack.back().m_pc = new_recvg_pc;
-                m_stack.back().m_branch_div_cycle = gpu_sim_cycle+gpu_tot_sim_cycle;
+                top().m_pc = new_recvg_pc;
+                top().m_branch_div_cycle = gpu_sim_cycle+gpu_tot_sim_cycle;
 
-                m_stack.push_back(simt_stack_entry());
+                push(simt_stack_entry());
             }
         }
 
@@ -764,19 +903,19 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
         if (warp_diverged && tmp_next_pc == new_recvg_pc) continue;
 
         // update the current top of pdom stack
-        m_stack.back().m_pc = tmp_next_pc;
-        m_stack.back().m_active_mask = tmp_active_mask;
+        top().m_pc = tmp_next_pc;
+        top().m_active_mask = tmp_active_mask;
         if (warp_diverged) {
-            m_stack.back().m_calldepth = 0;
-            m_stack.back().m_recvg_pc = new_recvg_pc;
+            top().m_calldepth = 0;
+            top().m_recvg_pc = new_recvg_pc;
         } else {
-            m_stack.back().m_recvg_pc = top_recvg_pc;
+            top().m_recvg_pc = top_recvg_pc;
         }
 
-        m_stack.push_back(simt_stack_entry());
+        push(simt_stack_entry());
     }
-    assert(m_stack.size() > 0);
-    m_stack.pop_back();
+    assert(m_depth > 0);
+    pop();
 
 
     if (warp_diverged) {
@@ -809,14 +948,15 @@ void core_t::updateSIMTStack(unsigned warpId, warp_inst_t * inst)
     simt_mask_t thread_done;
     addr_vector_t next_pc;
     unsigned wtid = warpId * m_warp_size;
+    assert( m_warp_size <= MAX_WARP_SIZE_SIMT_STACK );
     for (unsigned i = 0; i < m_warp_size; i++) {
         if( ptx_thread_done(wtid+i) ) {
             thread_done.set(i);
-            next_pc.push_back( (address_type)-1 );
+            next_pc[i] = (address_type)-1;
         } else {
             if( inst->reconvergence_pc == RECONVERGE_RETURN_PC ) 
                 inst->reconvergence_pc = get_return_pc(m_thread[wtid+i]);
-            next_pc.push_back( m_thread[wtid+i]->get_pc() );
+            next_pc[i] = m_thread[wtid+i]->get_pc();
         }
     }
     m_simt_stack[warpId]->update(thread_done,next_pc,inst->reconvergence_pc, inst->op,inst->isize,inst->pc);
@@ -296,7 +296,7 @@ const unsigned MAX_WARP_SIZE = 32;
 typedef std::bitset<MAX_WARP_SIZE> active_mask_t;
 #define MAX_WARP_SIZE_SIMT_STACK  MAX_WARP_SIZE
 typedef std::bitset<MAX_WARP_SIZE_SIMT_STACK> simt_mask_t;
-typedef std::vector<address_type> addr_vector_t;
+typedef address_type addr_vector_t[MAX_WARP_SIZE_SIMT_STACK]; // next pc of each thread in a warp
 
 class simt_stack {
 public:
@@ -304,7 +304,7 @@ public:
 
     void reset();
     void launch( address_type start_pc, const simt_mask_t &active_mask );
-    void update( simt_mask_t &thread_done, addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op,unsigned next_inst_size, address_type next_inst_pc );
+    void update( simt_mask_t &thread_done, const addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op,unsigned next_inst_size, address_type next_inst_pc );
 
     const simt_mask_t &get_active_mask() const;
     void     get_pdom_stack_top_info( unsigned *pc, unsigned *rpc ) const;
@@ -331,7 +331,20 @@ protected:
             m_pc(-1), m_calldepth(0), m_active_mask(), m_recvg_pc(-1), m_branch_div_cycle(0), m_type(STACK_ENTRY_TYPE_NORMAL) { };
     };
 
-    std::deque<simt_stack_entry> m_stack;
+    simt_stack_entry &top() { assert(m_depth > 0); return m_stack[m_depth-1]; }
+    const simt_stack_entry &top() const { assert(m_depth > 0); return m_stack[m_depth-1]; }
+    void push( const simt_stack_entry &entry )
+    {
+        if( m_depth == m_stack.size() )
+            m_stack.resize(2*m_stack.size()); // deep call chains only; divergence alone stays within the initial bound
+        m_stack[m_depth++] = entry;
+    }
+    void pop() { assert(m_depth > 0); m_depth--; }
+
+    // entries [0,m_depth) are live; storage is sized once for the worst-case
+    // divergence nesting of a warp so update() does not allocate
+    std::vector<simt_stack_entry> m_stack;
+    unsigned m_depth;
 };
 
 #define GLOBAL_HEAP_START 0x80000000
@@ -701,8 +714,10 @@ public:
 #define MAX_REG_OPERANDS 8
 
 struct dram_callback_t {
-   dram_callback_t() { function=NULL; instruction=NULL; thread=NULL; }
+   dram_callback_t() { function=NULL; warp_function=NULL; instruction=NULL; thread=NULL; }
    void (*function)(const class inst_t*, class ptx_thread_info*);
+   // optional warp-level form of 'function', called once with all participating threads (in lane order)
+   void (*warp_function)(const class inst_t*, class ptx_thread_info**, unsigned);
 
    const class inst_t* instruction;
    class ptx_thread_info *thread;
@@ -885,6 +900,7 @@ public:
            return false;
         }
     };
+    struct transaction_table; // per-subwarp grouping of lanes into transactions
 
     void generate_mem_accesses();
     void memory_coalescing_arch_13( bool is_write, mem_access_type access_type );
@@ -895,7 +911,8 @@ public:
                        void (*function)(const class inst_t*, class ptx_thread_info*),
                        const inst_t *inst, 
                        class ptx_thread_info *thread,
-                       bool atomic)
+                       bool atomic,
+                       void (*warp_function)(const class inst_t*, class ptx_thread_info**, unsigned)=NULL )
     {
         if( !m_per_scalar_thread_valid ) {
             m_per_scalar_thread.resize(m_config->warp_size);
@@ -903,6 +920,7 @@ public:
             if(atomic) m_isatomic=true;
         }
         m_per_scalar_thread[lane_id].callback.function = function;
+        m_per_scalar_thread[lane_id].callback.warp_function = warp_function;
         m_per_scalar_thread[lane_id].callback.instruction = inst;
         m_per_scalar_thread[lane_id].callback.thread = thread;
     }
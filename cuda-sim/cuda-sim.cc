@@ -41,6 +41,7 @@
 #include "../abstract_hardware_model.h"
 #include "memory.h"
 #include "ptx-stats.h"
+#include "cuda_device_printf.h"
 #include "ptx_loader.h"
 #include "ptx_parser.h"
 #include "../gpgpu-sim/gpu-sim.h"
@@ -177,6 +178,14 @@ void gpgpu_t::gpgpu_ptx_sim_bindTextureToArray(const struct textureReference* te
 unsigned g_assemble_code_next_pc=0; 
 std::map<unsigned,function_info*> g_pc_to_finfo;
 std::vector<ptx_instruction*> function_info::s_g_pc_to_insn;
+std::vector<address_type> function_info::s_g_pc_to_recvg_pc;
+
+struct rec_pts {
+   gpgpu_recon_t *s_kernel_recon_points;
+   int s_num_recon;
+};
+
+struct rec_pts find_reconvergence_points( function_info *finfo );
 
 #define MAX_INST_SIZE 8 /*bytes*/
 
@@ -270,6 +279,18 @@ void function_info::ptx_assemble()
       print_ipostdominators();
    }
 
+   // record the post-dominator analysis in the PC-indexed reconvergence table so 
+   // that decoding a branch does not need to search the reconvergence pairs
+   s_g_pc_to_recvg_pc.resize(s_g_pc_to_insn.size(),NO_BRANCH_DIVERGENCE);
+   rec_pts rpts = find_reconvergence_points(this);
+   for( int r=0; r < rpts.s_num_recon; r++ ) {
+      const gpgpu_recon_t &recon = rpts.s_kernel_recon_points[r];
+      if( recon.target_pc == (unsigned) -2 ) 
+         s_g_pc_to_recvg_pc[recon.source_pc] = RECONVERGE_RETURN_PC;
+      else
+         s_g_pc_to_recvg_pc[recon.source_pc] = recon.target_pc;
+   }
+
    printf("GPGPU-Sim PTX: pre-decoding instructions for \'%s\'...\n", m_name.c_str() );
    for ( unsigned ii=0; ii < n; ii += m_instr_mem[ii]->inst_size() ) { // handle branch instructions
       ptx_instruction *pI = m_instr_mem[ii];
@@ -1299,7 +1320,7 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
    if ( pI->get_opcode() == ATOM_OP ) {
       insn_memaddr = last_eaddr();
       insn_space = last_space();
-      inst.add_callback( lane_id, last_callback().function, last_callback().instruction, this,true /*atomic*/);
+      inst.add_callback( lane_id, last_callback().function, last_callback().instruction, this,true /*atomic*/, last_callback().warp_function);
       unsigned to_type = pI->get_type();
       insn_data_size = datatype2size(to_type);
    }
@@ -1747,6 +1768,7 @@ void gpgpu_cuda_ptx_sim_main_func( kernel_info_t &kernel, bool openCL )
         );
         cta.execute();
     }
+    gpgpusim_cuda_printf_flush(kernel.get_uid());
     
    //registering this kernel as done      
    extern stream_manager *g_stream_manager;
@@ -1800,6 +1822,9 @@ void functionalCoreSim::initializeCTA()
         assert(m_thread[i]!=NULL && !m_thread[i]->is_done());
         ctaLiveThreads++;
     }
+    dim3 ctaid = m_thread[0]->get_ctaid();
+    dim3 grid = m_kernel->get_grid_dim();
+    m_cta_id = ctaid.x + grid.x*(ctaid.y + grid.y*ctaid.z);
     
     for(int k=0;k<m_warp_count;k++)
         createWarp(k);
@@ -1845,6 +1870,7 @@ void functionalCoreSim::executeWarp(unsigned i, bool &allAtBarrier, bool & someO
         warp_inst_t inst =getExecuteWarp(i);
         execute_warp_inst_t(inst,i);
         if(inst.isatomic()) inst.do_atomic(true);
+        m_gpu->functional_cache_warm(inst,m_cta_id);
         if(inst.op==BARRIER_OP || inst.op==MEMORY_BARRIER_OP ) m_warpAtBarrier[i]=true;
         updateSIMTStack( i, &inst );
     }
@@ -1954,11 +1980,6 @@ void ptxinfo_opencl_addinfo( std::map<std::string,function_info*> &kernels )
    clear_ptxinfo();
 }
 
-struct rec_pts {
-   gpgpu_recon_t *s_kernel_recon_points;
-   int s_num_recon;
-};
-
 struct std::map<function_info*,rec_pts> g_rpts;
 
 struct rec_pts find_reconvergence_points( function_info *finfo )
@@ -2005,23 +2026,7 @@ address_type get_converge_point( address_type pc )
    // the branch could encode the reconvergence point and/or a bit that indicates the 
    // reconvergence point is the return PC on the call stack in the case the branch has 
    // no immediate postdominator in the function (i.e., due to multiple return points). 
-
-   std::map<unsigned,function_info*>::iterator f=g_pc_to_finfo.find(pc);
-   assert( f != g_pc_to_finfo.end() );
-   function_info *finfo = f->second;
-   rec_pts tmp = find_reconvergence_points(finfo);
-
-   int i=0;
-   for (; i < tmp.s_num_recon; ++i) {
-      if (tmp.s_kernel_recon_points[i].source_pc == pc) {
-          if( tmp.s_kernel_recon_points[i].target_pc == (unsigned) -2 ) {
-              return RECONVERGE_RETURN_PC;
-          } else {
-              return tmp.s_kernel_recon_points[i].target_pc;
-          }
-      }
-   }
-   return NO_BRANCH_DIVERGENCE;
+   return function_info::pc_to_reconvergence_pc(pc);
 }
 
 void functionalCoreSim::warp_exit( unsigned warp_id )
@@ -106,6 +106,7 @@ public:
     
 private:
     void executeWarp(unsigned, bool &, bool &);
+    unsigned m_cta_id; // linear id of the CTA being executed
     //initializes threads in the CTA block which we are executing
     void initializeCTA();
     virtual void checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned t, unsigned tid)
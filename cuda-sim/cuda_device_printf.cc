@@ -27,6 +27,8 @@
 
 #include "cuda_device_printf.h"
 #include "ptx_ir.h"
+#include <algorithm>
+#include <stdlib.h>
 
 void decode_space( memory_space_t &space, ptx_thread_info *thread, const operand_info &op, memory_space *&mem, addr_t &addr);
 
@@ -68,10 +70,111 @@ void my_cuda_printf(const char *fmtstr,const char *arg_list)
    }
 }
 
+// options
+unsigned g_ptx_printf_buffer_size;
+
+void cuda_device_printf_options(option_parser_t opp)
+{
+   option_parser_register(opp, "-gpgpu_ptx_printf_buffer_size", OPT_UINT32, 
+                          &g_ptx_printf_buffer_size, 
+                          "Bytes of device printf argument data buffered per kernel before output is "
+                          "flushed in thread order (0 = print synchronously)", "1048576");
+}
+
+// device printf records are kept in binary form (format string id + raw argument
+// bytes) and only formatted when the kernel completes or its buffer fills up
+struct printf_record {
+   unsigned cta;          // linear CTA id 
+   unsigned tid;          // linear thread id within the CTA
+   unsigned fmt_id;       // index into g_printf_fmt_strings
+   unsigned arg_offset;   // offset of argument bytes in printf_buffer::args
+};
+
+struct printf_buffer {
+   std::vector<printf_record> records;
+   std::vector<char> args;
+};
+
+static std::map<std::pair<const memory_space*,addr_t>,unsigned> g_printf_fmt_ids;
+static std::map<std::string,unsigned> g_printf_fmt_by_content;
+static std::vector<std::string> g_printf_fmt_strings;
+static std::map<unsigned,printf_buffer> g_printf_buffers; // kernel uid -> captured records
+
+static bool printf_record_order( const printf_record &a, const printf_record &b )
+{
+   if( a.cta != b.cta ) 
+      return a.cta < b.cta;
+   return a.tid < b.tid;
+}
+
+static void printf_buffer_drain( printf_buffer &buf )
+{
+   // stable: records of one thread stay in program order
+   std::stable_sort(buf.records.begin(),buf.records.end(),printf_record_order);
+   for( unsigned r=0; r < buf.records.size(); r++ ) {
+      const printf_record &rec = buf.records[r];
+      my_cuda_printf(g_printf_fmt_strings[rec.fmt_id].c_str(),&buf.args[rec.arg_offset]);
+   }
+   fflush(stdout);
+   buf.records.clear();
+   buf.args.clear();
+}
+
+// Format strings are interned by content, so each distinct string is stored
+// once. Global and constant memory addresses are also used as cache keys to
+// skip reading the string: a string in local or shared memory lives at an
+// address that is reused by other threads and kernels, so it is read every time.
+static unsigned printf_fmt_id( const memory_space *mem, addr_t addr, memory_space_t space )
+{
+   bool cacheable = (space.get_type() == global_space || space.get_type() == const_space);
+   std::pair<const memory_space*,addr_t> key(mem,addr);
+   if( cacheable ) {
+      std::map<std::pair<const memory_space*,addr_t>,unsigned>::iterator f = g_printf_fmt_ids.find(key);
+      if( f != g_printf_fmt_ids.end() ) 
+         return f->second;
+   }
+   std::string fmt;
+   char b = 0;
+   mem->read(addr,1,&b);
+   for( unsigned len=1; b; len++ ) {
+      fmt.push_back(b);
+      mem->read(addr+len,1,&b);
+   }
+   unsigned id;
+   std::map<std::string,unsigned>::iterator s = g_printf_fmt_by_content.find(fmt);
+   if( s != g_printf_fmt_by_content.end() ) {
+      id = s->second;
+   } else {
+      id = g_printf_fmt_strings.size();
+      g_printf_fmt_strings.push_back(fmt);
+      g_printf_fmt_by_content[fmt] = id;
+   }
+   if( cacheable ) 
+      g_printf_fmt_ids[key] = id;
+   return id;
+}
+
+// Output of kernels that never complete must not be lost: whatever is still
+// buffered at exit is drained here; the simulator's own abort() sites call
+// gpgpusim_cuda_printf_flush_all() before aborting.
+static void printf_flush_at_exit()
+{
+   gpgpusim_cuda_printf_flush_all();
+}
+
+static void printf_install_flush_hooks()
+{
+   static bool installed = false;
+   if( installed ) 
+      return;
+   installed = true;
+   atexit(printf_flush_at_exit);
+}
+
 void gpgpusim_cuda_vprintf(const ptx_instruction * pI, ptx_thread_info * thread, const function_info * target_func ) 
 {
-      char *fmtstr = NULL;
-      char *arg_list = NULL;
+      unsigned fmt_id = 0;
+      std::vector<char> arg_list;
       unsigned n_return = target_func->has_return();
       unsigned n_args = target_func->num_args();
       assert( n_args == 2 );
@@ -90,25 +193,51 @@ void gpgpusim_cuda_vprintf(const ptx_instruction * pI, ptx_thread_info * thread,
          memory_space_t space = generic_space;
          decode_space(space,thread,actual_param_op,mem,addr); // figure out which space
          if( arg == 0 ) {
-            unsigned len = 0;
-            char b = 0;
-            do { // figure out length
-               mem->read(addr+len,1,&b);
-               len++;
-            } while(b);
-            fmtstr = (char*)malloc(len+64);
-            for( int i=0; i < len; i++ ) 
-               mem->read(addr+i,1,fmtstr+i);
-            //mem->read(addr,len,fmtstr);
+            fmt_id = printf_fmt_id(mem,addr,space);
          } else {
             unsigned len = thread->get_finfo()->local_mem_framesize();
-            arg_list = (char*)malloc(len+64);
-            for( int i=0; i < len; i++ ) 
-               mem->read(addr+i,1,arg_list+i);
-            //mem->read(addr,len,arg_list);
+            arg_list.resize(len+64);
+            mem->read(addr,len,&arg_list[0]);
          }
       }
-      my_cuda_printf(fmtstr,arg_list);
-      free(fmtstr);
-      free(arg_list);
+
+      if( g_ptx_printf_buffer_size == 0 ) {
+         my_cuda_printf(g_printf_fmt_strings[fmt_id].c_str(),&arg_list[0]);
+         return;
+      }
+
+      const kernel_info_t &kernel = thread->get_kernel();
+      dim3 ctaid = thread->get_ctaid();
+      dim3 tid = thread->get_tid();
+      dim3 grid = kernel.get_grid_dim();
+      dim3 block = kernel.get_cta_dim();
+      printf_record rec;
+      rec.cta = ctaid.x + grid.x*(ctaid.y + grid.y*ctaid.z);
+      rec.tid = tid.x + block.x*(tid.y + block.y*tid.z);
+      rec.fmt_id = fmt_id;
+
+      printf_install_flush_hooks();
+      printf_buffer &buf = g_printf_buffers[kernel.get_uid()];
+      if( !buf.records.empty() && buf.args.size() + arg_list.size() > g_ptx_printf_buffer_size ) 
+         printf_buffer_drain(buf);
+      rec.arg_offset = buf.args.size();
+      buf.args.insert(buf.args.end(),arg_list.begin(),arg_list.end());
+      buf.records.push_back(rec);
+}
+
+void gpgpusim_cuda_printf_flush( unsigned kernel_uid )
+{
+   std::map<unsigned,printf_buffer>::iterator b = g_printf_buffers.find(kernel_uid);
+   if( b == g_printf_buffers.end() ) 
+      return;
+   printf_buffer_drain(b->second);
+   g_printf_buffers.erase(b);
+}
+
+void gpgpusim_cuda_printf_flush_all()
+{
+   std::map<unsigned,printf_buffer>::iterator b;
+   for( b=g_printf_buffers.begin(); b != g_printf_buffers.end(); b++ ) 
+      printf_buffer_drain(b->second);
+   g_printf_buffers.clear();
 }
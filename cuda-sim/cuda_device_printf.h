@@ -28,6 +28,20 @@
 #ifndef CUDA_DEVICE_PRINTF_INCLUDED
 #define CUDA_DEVICE_PRINTF_INCLUDED
 
+#include "../option_parser.h"
+
+void cuda_device_printf_options(option_parser_t opp);
+
+// captures one device printf call; the output is emitted by gpgpusim_cuda_printf_flush()
+// (or immediately if buffering is disabled)
 void gpgpusim_cuda_vprintf(const class ptx_instruction * pI, class ptx_thread_info * thread, const class function_info * target_func );
 
+// formats and writes all printf records captured for the given kernel, ordered by 
+// CTA id then thread id (program order within a thread)
+void gpgpusim_cuda_printf_flush( unsigned kernel_uid );
+
+// flushes the records of every kernel, in kernel launch order; used when kernels
+// will not complete (simulation limit reached, exit, before the simulator aborts)
+void gpgpusim_cuda_printf_flush_all();
+
 #endif
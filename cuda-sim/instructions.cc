@@ -877,23 +877,19 @@ void bar_callback( const inst_t* inst, ptx_thread_info* thread)
 	thread->set_operand_value(dst,value, U32_TYPE, thread, pI);
 }
 
-void atom_callback( const inst_t* inst, ptx_thread_info* thread)
-{
-   const ptx_instruction *pI = dynamic_cast<const ptx_instruction*>(inst);
+// operands of one thread's atom instruction, decoded ahead of the memory access
+struct atom_operands {
+   memory_space *mem;
+   addr_t effective_address;
+   ptx_reg_t src2_data;   // b
+   ptx_reg_t src3_data;   // c (CAS only)
+};
 
-   // "Decode" the output type
+static void atom_decode_operands( const ptx_instruction *pI, ptx_thread_info *thread, atom_operands &ops )
+{
    unsigned to_type = pI->get_type();
-   size_t size;
-   int t;
-   type_info_key::type_decode(to_type, size, t);
 
-   // Set up operand variables
-   ptx_reg_t data;        // d
    ptx_reg_t src1_data;   // a
-   ptx_reg_t src2_data;   // b
-   ptx_reg_t op_result;   // temp variable to hold operation result
-
-   bool data_ready = false;
 
    // Get operand info of sources and destination
    const operand_info &dst  = pI->dst();     // d
@@ -903,10 +899,14 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread)
    // Get operand values
    src1_data = thread->get_operand_value(src1, src1, to_type, thread, 1);        // a
    if (dst.get_symbol()->type()){
-      src2_data = thread->get_operand_value(src2, dst, to_type, thread, 1);      // b
+      ops.src2_data = thread->get_operand_value(src2, dst, to_type, thread, 1);      // b
    } else {
 	   //This is the case whent he first argument (dest) is '_'
-      src2_data = thread->get_operand_value(src2, src1, to_type, thread, 1);     // b
+      ops.src2_data = thread->get_operand_value(src2, src1, to_type, thread, 1);     // b
+   }
+   if ( pI->get_atomic() == ATOMIC_CAS ) {
+      const operand_info &src3 = pI->src3();
+      ops.src3_data = thread->get_operand_value(src3, dst, to_type, thread, 1);  // c
    }
 
    // Check state space
@@ -927,20 +927,26 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread)
    } 
    assert( space == global_space || space == shared_space );
 
-   memory_space *mem = NULL;
+   ops.mem = NULL;
    if(space == global_space)
-       mem = thread->get_global_memory();
+       ops.mem = thread->get_global_memory();
    else if(space == shared_space)
-       mem = thread->m_shared_mem;
+       ops.mem = thread->m_shared_mem;
    else
        abort();
+   ops.effective_address = effective_address;
+}
 
-   // Copy value pointed to in operand 'a' into register 'd'
-   // (i.e. copy src1_data to dst)
-   mem->read(effective_address,size/8,&data.s64);
-   if (dst.get_symbol()->type()){
-	   thread->set_operand_value(dst, data, to_type, thread, pI);                         // Write value into register 'd'
-   }
+// computes the value an atom instruction writes back given the value 'data'
+// currently held in memory
+static ptx_reg_t atom_compute_result( const ptx_instruction *pI, const ptx_reg_t &data, const atom_operands &ops )
+{
+   unsigned to_type = pI->get_type();
+   const ptx_reg_t &src2_data = ops.src2_data;
+   const ptx_reg_t &src3_data = ops.src3_data;
+   ptx_reg_t op_result;   // temp variable to hold operation result
+
+   bool data_ready = false;
 
    // Get the atomic operation to be performed
    unsigned m_atomic_spec = pI->get_atomic();
@@ -1016,10 +1022,6 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread)
    case ATOMIC_CAS:
       {
 
-         ptx_reg_t src3_data;
-         const operand_info &src3 = pI->src3();
-         src3_data = thread->get_operand_value(src3, dst, to_type, thread, 1);
-
          switch ( to_type ) {
          case B32_TYPE:
          case U32_TYPE:
@@ -1178,14 +1180,96 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread)
       }
    }
 
-   // Write operation result into  memory
-   // (i.e. copy src1_data to dst)
-   if ( data_ready ) {
-      mem->write(effective_address,size/8,&op_result.s64,thread,pI);
-   } else {
+   if ( !data_ready ) {
       printf("Execution error: data_ready not set\n");
       assert(0);
    }
+   return op_result;
+}
+
+void atom_callback( const inst_t* inst, ptx_thread_info* thread)
+{
+   const ptx_instruction *pI = dynamic_cast<const ptx_instruction*>(inst);
+
+   // "Decode" the output type
+   unsigned to_type = pI->get_type();
+   size_t size;
+   int t;
+   type_info_key::type_decode(to_type, size, t);
+
+   atom_operands ops;
+   atom_decode_operands(pI, thread, ops);
+
+   // Copy value pointed to in operand 'a' into register 'd'
+   // (i.e. copy src1_data to dst)
+   ptx_reg_t data;
+   ops.mem->read(ops.effective_address,size/8,&data.s64);
+   const operand_info &dst = pI->dst();
+   if (dst.get_symbol()->type()){
+	   thread->set_operand_value(dst, data, to_type, thread, pI);                         // Write value into register 'd'
+   }
+
+   // Write operation result into  memory
+   ptx_reg_t op_result = atom_compute_result(pI, data, ops);
+   ops.mem->write(ops.effective_address,size/8,&op_result.s64,thread,pI);
+}
+
+// Warp-level form of atom_callback: threads are given in lane order and are
+// grouped by target location so that every unique address is read and written
+// once. Within a group the operations are applied in lane order, which gives
+// each thread the same old value it would see from per-thread execution.
+void atom_warp_callback( const inst_t* inst, ptx_thread_info** threads, unsigned nthreads )
+{
+   const ptx_instruction *pI = dynamic_cast<const ptx_instruction*>(inst);
+
+   unsigned to_type = pI->get_type();
+   size_t size;
+   int t;
+   type_info_key::type_decode(to_type, size, t);
+   const operand_info &dst = pI->dst();
+   bool has_dst = dst.get_symbol()->type();
+
+   assert( nthreads <= MAX_WARP_SIZE );
+   atom_operands ops[MAX_WARP_SIZE];
+   unsigned group_of[MAX_WARP_SIZE];
+   unsigned leader[MAX_WARP_SIZE]; // first thread of each group
+   unsigned ngroups = 0;
+   for( unsigned i=0; i < nthreads; i++ ) {
+      atom_decode_operands(pI, threads[i], ops[i]);
+      // same-address fast path: counters and histogram bins usually repeat
+      // the location of the previous lane
+      unsigned g = ngroups;
+      if( ngroups && ops[leader[ngroups-1]].mem == ops[i].mem && 
+          ops[leader[ngroups-1]].effective_address == ops[i].effective_address ) {
+         g = ngroups-1;
+      } else {
+         for( unsigned j=0; j < ngroups; j++ ) {
+            if( ops[leader[j]].mem == ops[i].mem && ops[leader[j]].effective_address == ops[i].effective_address ) {
+               g = j;
+               break;
+            }
+         }
+      }
+      if( g == ngroups ) 
+         leader[ngroups++] = i;
+      group_of[i] = g;
+   }
+
+   for( unsigned g=0; g < ngroups; g++ ) {
+      const atom_operands &loc = ops[leader[g]];
+      ptx_reg_t data;
+      loc.mem->read(loc.effective_address,size/8,&data.s64);
+      unsigned last = leader[g];
+      for( unsigned i=leader[g]; i < nthreads; i++ ) {
+         if( group_of[i] != g ) 
+            continue;
+         if( has_dst ) 
+            threads[i]->set_operand_value(dst, data, to_type, threads[i], pI);
+         data = atom_compute_result(pI, data, ops[i]);
+         last = i;
+      }
+      loc.mem->write(loc.effective_address,size/8,&data.s64,threads[last],pI);
+   }
 }
 
 // atom_impl will now result in a callback being called in mem_ctrl_pop (gpu-sim.c)
@@ -1230,6 +1314,7 @@ void atom_impl( const ptx_instruction *pI, ptx_thread_info *thread )
    thread->m_last_effective_address = effective_address_final;
    thread->m_last_memory_space = space;
    thread->m_last_dram_callback.function = atom_callback;
+   thread->m_last_dram_callback.warp_function = atom_warp_callback;
    thread->m_last_dram_callback.instruction = pI; 
 }
 
@@ -1333,6 +1418,7 @@ void bar_impl( const ptx_instruction *pIin, ptx_thread_info *thread )
    }
 
    thread->m_last_dram_callback.function = bar_callback;
+   thread->m_last_dram_callback.warp_function = NULL;
    thread->m_last_dram_callback.instruction = pIin;
 }
 
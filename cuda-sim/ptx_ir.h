@@ -1251,6 +1251,13 @@ public:
       else
           return NULL;
    }
+   // reconvergence PC of the branch at 'pc' (NO_BRANCH_DIVERGENCE if it is not a branch, 
+   // RECONVERGE_RETURN_PC if the branch reconverges at the function return)
+   static address_type pc_to_reconvergence_pc(unsigned pc) 
+   {
+      assert( pc < s_g_pc_to_recvg_pc.size() );
+      return s_g_pc_to_recvg_pc[pc];
+   }
    unsigned local_mem_framesize() const 
    { 
       return m_local_mem_framesize; 
@@ -1287,6 +1294,7 @@ private:
    symbol_table *m_symtab;
 
    static std::vector<ptx_instruction*> s_g_pc_to_insn; // a direct mapping from PC to instruction
+   static std::vector<address_type> s_g_pc_to_recvg_pc; // a direct mapping from PC to reconvergence PC, filled once per function at assembly
    static unsigned sm_next_uid;
 };
 
@@ -161,6 +161,7 @@ ptx_thread_info::ptx_thread_info( kernel_info_t &kernel )
    m_hw_wid = -1;
    m_hw_sid = -1;
    m_last_dram_callback.function = NULL;
+   m_last_dram_callback.warp_function = NULL;
    m_last_dram_callback.instruction = NULL;
    m_regs.push_back( reg_map_t() );
    m_debug_trace_regs_modified.push_back( reg_map_t() );
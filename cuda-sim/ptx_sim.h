@@ -403,6 +403,7 @@ public:
    memory_space *get_tex_memory() { return m_gpu->get_tex_memory(); }
    memory_space *get_surf_memory() { return m_gpu->get_surf_memory(); }
    memory_space *get_param_memory() { return m_kernel.get_param_memory(); }
+   const kernel_info_t &get_kernel() const { return m_kernel; }
    const gpgpu_functional_sim_config &get_config() const { return m_gpu->get_config(); }
    bool isInFunctionalSimulationMode(){ return m_functionalSimulationMode;}
    void exitCore()
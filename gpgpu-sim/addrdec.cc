@@ -27,6 +27,8 @@
 
 
 #include <string.h>
+#include <math.h>
+#include <vector>
 #include "addrdec.h"
 #include "gpu-sim.h"
 #include "../option_parser.h"
@@ -41,6 +43,13 @@ static void addrdec_getmasklimit(new_addr_type mask, unsigned char *high, unsign
 linear_to_raw_address_translation::linear_to_raw_address_translation()
 {
    addrdec_option = NULL;
+   addrdec_hash_bank_option = NULL;
+   addrdec_hash_chip_option = NULL;
+   addrdec_record_option = NULL;
+   addrdec_report_option = NULL;
+   m_record_file = NULL;
+   m_n_bk_xor = 0;
+   m_n_chip_xor = 0;
    ADDR_CHIP_S = 10;
    memset(addrdec_mklow,0,N_ADDRDEC);
    memset(addrdec_mkhigh,64,N_ADDRDEC);
@@ -62,46 +71,84 @@ void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp)
    option_parser_register(opp, "-gpgpu_mem_address_mask", OPT_INT32, &gpgpu_mem_address_mask, 
                "0 = old addressing mask, 1 = new addressing mask, 2 = new add. mask + flipped bank sel and chip sel bits",
                "0");
+   option_parser_register(opp, "-gpgpu_mem_addr_hash", OPT_INT32, &gpgpu_mem_addr_hash, 
+               "0 = no hashing, 1 = XOR low row bits into the bank, 2 = XOR low row bits into the bank and the channel, "
+               "3 = XOR masks from -gpgpu_mem_addr_hash_bank/-gpgpu_mem_addr_hash_chip",
+               "0");
+   option_parser_register(opp, "-gpgpu_mem_addr_hash_bank", OPT_CSTR, &addrdec_hash_bank_option,
+               "bank XOR hash for -gpgpu_mem_addr_hash 3: comma separated address masks, bank bit i ^= parity(addr & mask i)",
+               NULL);
+   option_parser_register(opp, "-gpgpu_mem_addr_hash_chip", OPT_CSTR, &addrdec_hash_chip_option,
+               "channel XOR hash for -gpgpu_mem_addr_hash 3: comma separated address masks, chip bit i ^= parity(addr & mask i)",
+               NULL);
+   option_parser_register(opp, "-gpgpu_mem_addr_record", OPT_CSTR, &addrdec_record_option,
+               "write the address of every memory request to this file (input for -gpgpu_mem_addr_report)",
+               NULL);
+   option_parser_register(opp, "-gpgpu_mem_addr_report", OPT_CSTR, &addrdec_report_option,
+               "replay a recorded address trace through the address mapping hashes, print channel/bank load balance and exit",
+               NULL);
+}
+
+void linear_to_raw_address_translation::bit_extract::init( new_addr_type m )
+{
+   mask = m;
+   n_runs = 0;
+   unsigned p = 0;
+   for (unsigned i=0; i < 64; ) {
+      if ((m & ((unsigned long long int)1<<i)) == 0) {
+         i++;
+         continue;
+      }
+      unsigned len = 0;
+      while (i+len < 64 && (m & ((unsigned long long int)1<<(i+len))) != 0) 
+         len++;
+      shift[n_runs] = i;
+      pos[n_runs] = p;
+      run_mask[n_runs] = (len == 64)? ~(new_addr_type)0 : (((new_addr_type)1 << len) - 1);
+      n_runs++;
+      p += len;
+      i += len;
+   }
 }
 
 new_addr_type linear_to_raw_address_translation::partition_address( new_addr_type addr ) const 
 { 
    if (!gap) {
-      return addrdec_packbits( ~(addrdec_mask[CHIP] | sub_partition_id_mask), addr, 64, 0 ); 
+      return m_partition_bits(addr); 
    } else {
       // see addrdec_tlx for explanation 
       unsigned long long int partition_addr; 
       partition_addr = ( (addr>>ADDR_CHIP_S) / m_n_channel) << ADDR_CHIP_S; 
       partition_addr |= addr & ((1 << ADDR_CHIP_S) - 1); 
       // remove the part of address that constributes to the sub partition ID
-      partition_addr = addrdec_packbits( ~sub_partition_id_mask, partition_addr, 64, 0); 
-      return partition_addr; 
+      return m_partition_bits(partition_addr); 
    }
 }
 
 void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr, addrdec_t *tlx) const
 {  
-   unsigned long long int addr_for_chip,rest_of_addr;
+   unsigned long long int rest_of_addr;
    if (!gap) {
-      tlx->chip = addrdec_packbits(addrdec_mask[CHIP], addr, addrdec_mkhigh[CHIP], addrdec_mklow[CHIP]);
-      tlx->bk   = addrdec_packbits(addrdec_mask[BK], addr, addrdec_mkhigh[BK], addrdec_mklow[BK]);
-      tlx->row  = addrdec_packbits(addrdec_mask[ROW], addr, addrdec_mkhigh[ROW], addrdec_mklow[ROW]);
-      tlx->col  = addrdec_packbits(addrdec_mask[COL], addr, addrdec_mkhigh[COL], addrdec_mklow[COL]);
-      tlx->burst= addrdec_packbits(addrdec_mask[BURST], addr, addrdec_mkhigh[BURST], addrdec_mklow[BURST]);
+      rest_of_addr = addr;
+      tlx->chip = m_field[CHIP](addr);
    } else {
       // Split the given address at ADDR_CHIP_S into (MSBs,LSBs)
       // - extract chip address using modulus of MSBs
       // - recreate the rest of the address by stitching the quotient of MSBs and the LSBs 
-      addr_for_chip = (addr>>ADDR_CHIP_S) % m_n_channel; 
-      rest_of_addr = ( (addr>>ADDR_CHIP_S) / m_n_channel) << ADDR_CHIP_S; 
-      rest_of_addr |= addr & ((1 << ADDR_CHIP_S) - 1); 
-
-      tlx->chip = addr_for_chip; 
-      tlx->bk   = addrdec_packbits(addrdec_mask[BK], rest_of_addr, addrdec_mkhigh[BK], addrdec_mklow[BK]);
-      tlx->row  = addrdec_packbits(addrdec_mask[ROW], rest_of_addr, addrdec_mkhigh[ROW], addrdec_mklow[ROW]);
-      tlx->col  = addrdec_packbits(addrdec_mask[COL], rest_of_addr, addrdec_mkhigh[COL], addrdec_mklow[COL]);
-      tlx->burst= addrdec_packbits(addrdec_mask[BURST], rest_of_addr, addrdec_mkhigh[BURST], addrdec_mklow[BURST]);
+      unsigned long long int msbs = addr>>ADDR_CHIP_S; 
+      unsigned long long int quotient = msbs / m_n_channel; 
+      rest_of_addr = (quotient << ADDR_CHIP_S) | (addr & ((1 << ADDR_CHIP_S) - 1)); 
+      tlx->chip = msbs - quotient * m_n_channel; 
    }
+   tlx->bk   = m_field[BK](rest_of_addr);
+   tlx->row  = m_field[ROW](rest_of_addr);
+   tlx->col  = m_field[COL](rest_of_addr);
+   tlx->burst= m_field[BURST](rest_of_addr);
+
+   for (unsigned i=0; i < m_n_bk_xor; i++) 
+      tlx->bk ^= (unsigned)__builtin_parityll(rest_of_addr & m_bk_xor[i]) << i;
+   for (unsigned i=0; i < m_n_chip_xor; i++) 
+      tlx->chip ^= (unsigned)__builtin_parityll(rest_of_addr & m_chip_xor[i]) << i;
 
    // combine the chip address and the lower bits of DRAM bank address to form the subpartition ID
    unsigned sub_partition_addr_mask = m_n_sub_partition_in_channel - 1; 
@@ -322,11 +369,172 @@ void linear_to_raw_address_translation::init(unsigned int n_channel, unsigned in
    }
    printf("sub_partition_id_mask = %016llx\n", sub_partition_id_mask);
 
+   for (i=0; i < N_ADDRDEC; i++) 
+      m_field[i].init(addrdec_mask[i]);
+   if (!gap) 
+      m_partition_bits.init(~(addrdec_mask[CHIP] | sub_partition_id_mask));
+   else 
+      m_partition_bits.init(~sub_partition_id_mask);
+
+   if (addrdec_report_option != NULL) {
+      mapping_report(addrdec_report_option);
+      exit(0);
+   }
+   set_hash(gpgpu_mem_addr_hash);
+   for (i=0; i < m_n_bk_xor; i++) 
+      printf("addr_dec_hash[BK%u]  = %016llx\n", i, m_bk_xor[i]);
+   for (i=0; i < m_n_chip_xor; i++) 
+      printf("addr_dec_hash[CHIP%u] = %016llx\n", i, m_chip_xor[i]);
+
+   if (addrdec_record_option != NULL) {
+      m_record_file = fopen(addrdec_record_option, "w");
+      if (m_record_file == NULL) {
+         fprintf(stderr, "ERROR: cannot open address record file '%s'\n", addrdec_record_option);
+         abort();
+      }
+   }
+
    if (run_test) {
       sweep_test(); 
    }
 }
 
+// k-th (from 0) set bit of mask, or -1
+static int addrdec_nth_bit( new_addr_type mask, unsigned k )
+{
+   for (int i=0; i < 64; i++) {
+      if ((mask >> i) & 1) {
+         if (k == 0) return i;
+         k--;
+      }
+   }
+   return -1;
+}
+
+unsigned linear_to_raw_address_translation::parse_xor_masks( const char *option, new_addr_type *masks, 
+                                                             unsigned max_bits, new_addr_type allowed ) const
+{
+   unsigned n = 0;
+   const char *p = option;
+   while (p && *p) {
+      char *end;
+      new_addr_type m = strtoull(p, &end, 0);
+      if (end == p) {
+         fprintf(stderr, "ERROR: Invalid address hash mask list '%s'\n", option);
+         abort();
+      }
+      if (n >= max_bits) {
+         fprintf(stderr, "ERROR: Address hash '%s' has more masks than field bits (%u)\n", option, max_bits);
+         abort();
+      }
+      if (m & ~allowed) 
+         printf("GPGPU-Sim uArch: address hash mask %016llx uses bank/chip bits, ignoring them\n", m);
+      masks[n++] = m & allowed;
+      p = end;
+      while (*p == ',' || *p == ':' || *p == ' ') 
+         p++;
+   }
+   return n;
+}
+
+// Select the XOR hash applied on top of the bit mask mapping:
+// 0 = none, 1 = bank ^= low row bits, 2 = bank and chip ^= low row bits (permutation based 
+// interleaving), 3 = user supplied XOR masks
+void linear_to_raw_address_translation::set_hash( int mode )
+{
+   unsigned n_bk_bits = __builtin_popcountll(addrdec_mask[BK]);
+   unsigned n_chip_bits = gap? 0 : __builtin_popcountll(addrdec_mask[CHIP]);
+   m_n_bk_xor = 0;
+   m_n_chip_xor = 0;
+   if (mode == 2 && gap) 
+      printf("GPGPU-Sim uArch: channel XOR hashing needs a power of two number of channels, hashing banks only\n");
+   switch (mode) {
+   case 0: 
+      break;
+   case 1: 
+   case 2: 
+      for (unsigned b=0; b < n_bk_bits; b++) {
+         int r = addrdec_nth_bit(addrdec_mask[ROW], b);
+         if (r >= 0) 
+            m_bk_xor[m_n_bk_xor++] = 1ULL << r;
+      }
+      if (mode == 2) {
+         for (unsigned b=0; b < n_chip_bits; b++) {
+            int r = addrdec_nth_bit(addrdec_mask[ROW], b);
+            if (r >= 0) 
+               m_chip_xor[m_n_chip_xor++] = 1ULL << r;
+         }
+      }
+      break;
+   case 3: {
+      bool has_bank = addrdec_hash_bank_option && *addrdec_hash_bank_option;
+      bool has_chip = addrdec_hash_chip_option && *addrdec_hash_chip_option;
+      if (!has_bank && !has_chip) {
+         fprintf(stderr, "ERROR: -gpgpu_mem_addr_hash 3 needs -gpgpu_mem_addr_hash_bank and/or -gpgpu_mem_addr_hash_chip\n");
+         abort();
+      }
+      if (has_chip && gap) 
+         printf("GPGPU-Sim uArch: WARNING: -gpgpu_mem_addr_hash_chip ignored, channel XOR hashing needs a power of two number of channels\n");
+      new_addr_type allowed = ~(addrdec_mask[CHIP] | addrdec_mask[BK]);
+      m_n_bk_xor = parse_xor_masks(addrdec_hash_bank_option, m_bk_xor, n_bk_bits, allowed);
+      if (n_chip_bits) 
+         m_n_chip_xor = parse_xor_masks(addrdec_hash_chip_option, m_chip_xor, n_chip_bits, allowed);
+      } break;
+   default:
+      fprintf(stderr, "ERROR: Invalid -gpgpu_mem_addr_hash %d\n", mode);
+      abort();
+   }
+}
+
+// Offline evaluation of address mapping hashes: replay a trace written by
+// -gpgpu_mem_addr_record (one hex address per line) through every hash mode
+// and print how evenly requests spread over channels and banks.
+void linear_to_raw_address_translation::mapping_report( const char *trace_file )
+{
+   FILE *fp = fopen(trace_file, "r");
+   if (fp == NULL) {
+      fprintf(stderr, "ERROR: cannot open address trace '%s'\n", trace_file);
+      abort();
+   }
+   std::vector<new_addr_type> trace;
+   unsigned long long addr;
+   while (fscanf(fp, "%llx", &addr) == 1) 
+      trace.push_back(addr);
+   fclose(fp);
+
+   unsigned n_bk = 1u << __builtin_popcountll(addrdec_mask[BK]);
+   printf("Address mapping report: %zu requests, %d channels x %u banks\n", trace.size(), m_n_channel, n_bk);
+   static const char *mode_name[] = { "none", "bank xor", "bank+chip xor", "custom xor" };
+   int last_mode = (addrdec_hash_bank_option || addrdec_hash_chip_option)? 3 : 2;
+   for (int mode=0; mode <= last_mode; mode++) {
+      set_hash(mode);
+      std::vector<unsigned long long> chip_count(m_n_channel, 0);
+      std::vector<unsigned long long> bank_count(m_n_channel * n_bk, 0);
+      for (size_t t=0; t < trace.size(); t++) {
+         addrdec_t tlx;
+         addrdec_tlx(trace[t], &tlx);
+         chip_count[tlx.chip]++;
+         bank_count[tlx.chip * n_bk + tlx.bk]++;
+      }
+      double chip_avg = (double)trace.size() / chip_count.size();
+      double bank_avg = (double)trace.size() / bank_count.size();
+      double chip_var = 0, bank_var = 0;
+      unsigned long long chip_max = 0, bank_max = 0;
+      for (size_t c=0; c < chip_count.size(); c++) {
+         chip_var += (chip_count[c] - chip_avg) * (chip_count[c] - chip_avg);
+         if (chip_count[c] > chip_max) chip_max = chip_count[c];
+      }
+      for (size_t b=0; b < bank_count.size(); b++) {
+         bank_var += (bank_count[b] - bank_avg) * (bank_count[b] - bank_avg);
+         if (bank_count[b] > bank_max) bank_max = bank_count[b];
+      }
+      printf("  hash %d (%s): channel max/avg = %.3f cv = %.3f, bank max/avg = %.3f cv = %.3f\n", 
+             mode, mode_name[mode], 
+             chip_avg? chip_max / chip_avg : 0, chip_avg? sqrt(chip_var / chip_count.size()) / chip_avg : 0, 
+             bank_avg? bank_max / bank_avg : 0, bank_avg? sqrt(bank_var / bank_count.size()) / bank_avg : 0);
+   }
+}
+
 #include "../tr1_hash_map.h" 
 
 bool operator==(const addrdec_t &x, const addrdec_t &y) 
@@ -34,6 +34,9 @@
 #define ADDRDEC_H
 
 #include "../abstract_hardware_model.h"
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 
 struct addrdec_t {
    void print( FILE *fp ) const;
@@ -57,9 +60,42 @@ public:
    void addrdec_tlx(new_addr_type addr, addrdec_t *tlx) const; 
    new_addr_type partition_address( new_addr_type addr ) const;
 
+   // append addr to the -gpgpu_mem_addr_record trace (for -gpgpu_mem_addr_report)
+   void record( new_addr_type addr ) const { if (m_record_file) fprintf(m_record_file, "%llx\n", addr); }
+   // push buffered trace lines to disk, so that an abort() does not truncate the trace
+   void flush_record() const { if (m_record_file) fflush(m_record_file); }
+
 private:
+   // A bit mask compiled at init into its contiguous runs of ones, so that
+   // gathering the masked bits of an address into the low bits of the
+   // result (what addrdec_packbits() does one bit at a time) takes one
+   // shift/and/or per run, or a single PEXT on BMI2 hosts.
+   struct bit_extract {
+      void init( new_addr_type m );
+      new_addr_type operator()( new_addr_type addr ) const
+      {
+#if defined(__BMI2__)
+         return _pext_u64(addr, mask);
+#else
+         new_addr_type result = 0;
+         for (unsigned r=0; r < n_runs; r++) 
+            result |= ((addr >> shift[r]) & run_mask[r]) << pos[r];
+         return result;
+#endif
+      }
+
+      new_addr_type mask;
+      unsigned n_runs;
+      unsigned char shift[32];
+      unsigned char pos[32];
+      new_addr_type run_mask[32];
+   };
+
    void addrdec_parseoption(const char *option);
    void sweep_test() const; // sanity check to ensure no overlapping
+   void set_hash( int mode );
+   unsigned parse_xor_masks( const char *option, new_addr_type *masks, unsigned max_bits, new_addr_type allowed ) const;
+   void mapping_report( const char *trace_file ); 
 
    enum {
       CHIP  = 0,
@@ -72,6 +108,11 @@ private:
 
    const char *addrdec_option;
    int gpgpu_mem_address_mask;
+   int gpgpu_mem_addr_hash;
+   const char *addrdec_hash_bank_option;
+   const char *addrdec_hash_chip_option;
+   const char *addrdec_record_option;
+   const char *addrdec_report_option;
    bool run_test; 
 
    int ADDR_CHIP_S;
@@ -80,6 +121,18 @@ private:
    new_addr_type addrdec_mask[N_ADDRDEC];
    new_addr_type sub_partition_id_mask; 
 
+   bit_extract m_field[N_ADDRDEC];
+   bit_extract m_partition_bits;    // address bits kept by partition_address()
+   // XOR hashing: bank (chip) bit i is flipped by the parity of the address
+   // bits selected by m_bk_xor[i] (m_chip_xor[i]); the masks never cover bank
+   // or chip bits, so the mapping stays a bijection
+   unsigned m_n_bk_xor;
+   unsigned m_n_chip_xor;
+   new_addr_type m_bk_xor[32];
+   new_addr_type m_chip_xor[32];
+
+   FILE *m_record_file;
+
    unsigned int gap;
    int m_n_channel;
    int m_n_sub_partition_in_channel; 
@@ -49,10 +49,15 @@ dram_t::dram_t( unsigned int partition_id, const struct memory_config *config, m
    m_stats = stats;
    m_config = config;
 
-   CCDc = 0;
-   RRDc = 0;
-   RTWc = 0;
-   WTRc = 0;
+   CCD = 0;
+   RRD = 0;
+   RTW = 0;
+   WTR = 0;
+   m_dram_cycle = 0;
+   m_quiet_at = 0;
+   m_busy_banks = 0;
+   m_rwq_cmds = 0;
+   m_idle_cycles = 0;
 
    rw = READ; //read mode is default
 
@@ -62,8 +67,8 @@ dram_t::dram_t( unsigned int partition_id, const struct memory_config *config, m
 		bkgrp[i] = bkgrp[0] + i;
 	}
 	for (unsigned i=0; i<m_config->nbkgrp; i++) {
-		bkgrp[i]->CCDLc = 0;
-		bkgrp[i]->RTPLc = 0;
+		bkgrp[i]->CCDL = 0;
+		bkgrp[i]->RTPL = 0;
 	}
 
    bk = (bank_t**) calloc(sizeof(bank_t*),m_config->nbk);
@@ -193,21 +198,44 @@ void dram_t::scheduler_fifo()    // FIFO调度策略
       dram_req_t *head_mrqq = mrqq->top();   // 取出队首元素（dram_req_t）
       head_mrqq->data->set_status(IN_PARTITION_MC_BANK_ARB_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle); // 设置状态
       bkn = head_mrqq->bk; // 获取该内存访问的bank的ID
-      if (!bk[bkn]->mrq)   // 查看这个bank上是否存在请求
+      if (!bk[bkn]->mrq) { // 查看这个bank上是否存在请求
          bk[bkn]->mrq = mrqq->pop();   // 不存在请求（请求是空的），则将FIFO中队首请求弹出，放入bank（此时认为：访存请求进入DRAM channel）
+         m_busy_banks++;
+      }
    }
 }
 
 
-#define DEC2ZERO(x) x = (x)? (x-1) : 0;
 #define SWAP(a,b) a ^= b; b ^= a; a ^= b;
 
+// Nothing queued, in flight or assigned to a bank: the scheduler and bank loop
+// cannot change any state, so only the per-cycle statistics are advanced.
+void dram_t::idle_cycle()
+{
+   n_nop++;
+   n_nop_partial++;
+   if (!elapsed(m_quiet_at)) {
+      n_activity++;
+      n_activity_partial++;
+   }
+   n_cmd++;
+   n_cmd_partial++;
+   m_idle_cycles++;
+   m_dram_cycle++;
+}
+
 void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，其实就是全部DRAM channel的运行
 {
+   if (m_busy_banks == 0 && m_rwq_cmds == 0 && mrqq->empty() && 
+       (!m_frfcfs_scheduler || m_frfcfs_scheduler->num_pending() == 0)) {
+      idle_cycle();
+      return;
+   }
    // 查看DRAM channel的“DRAM返回队列”是否满了
    if( !returnq->full() ) {
       dram_req_t *cmd = rwq->pop();   // 从rwq中取出cmd（访存请求，可能是：读/写）
       if( cmd ) {   // cmd不空
+         m_rwq_cmds--;
 #ifdef DRAM_VIEWCMD 
            printf("\tDQ: BK%d Row:%03x Col:%03x", cmd->bk, cmd->row, cmd->col + cmd->dqbytes);  // DQ: BK   Row:row  Col:col + dqbytes
 #endif
@@ -265,10 +293,10 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
       if (bk[j]->mrq) { // bank[j]中存在访存请求mrq     /// if currently servicing a memory request
          bk[j]->mrq->data->set_status(IN_PARTITION_DRAM,gpu_sim_cycle+gpu_tot_sim_cycle);   // 设置该请求的data（mf）状态
          // *************************************** 访存请求mrq的行为：”读取“，bank[j]处于“激活”状态（上一次操作的”行选信号“仍有效 且 上次的“行选信号” == mrq的”行选信号“） /// correct row activated for a READ /// 这里说一说为什么CCDc、RCDc等相关的时延参数必须等于0
-         if ( !issued && !CCDc && !bk[j]->RCDc &&  // 未发射 && CCDc：列选信号之间的开销 && bank[j]执行”读取“操作时，从“行选信号”选通到”列选信号“选通所花费的时间 == 0
-              !(bkgrp[grp]->CCDLc) &&              // bank[j]所在的group的CCDLc == 0
+         if ( !issued && elapsed(CCD) && elapsed(bk[j]->RCD) &&  // 未发射 && CCDc：列选信号之间的开销 && bank[j]执行”读取“操作时，从“行选信号”选通到”列选信号“选通所花费的时间 == 0
+              elapsed(bkgrp[grp]->CCDL) &&         // bank[j]所在的group的CCDLc == 0
               (bk[j]->curr_row == bk[j]->mrq->row) &&       // ID为j的bank（bank[j]）当前的行号 == 访存请求指定的行号
-              (bk[j]->mrq->rw == READ) && (WTRc == 0 )  &&  // 访存请求mrq的操作为“读取” && ”写入“转为”读取“所花的时间 == 0
+              (bk[j]->mrq->rw == READ) && elapsed(WTR)  &&  // 访存请求mrq的操作为“读取” && ”写入“转为”读取“所花的时间 == 0
               (bk[j]->state == BANK_ACTIVE) &&     // ID为j的bank(bank[j])处于激活状态
               !rwq->full() ) {                     // rwq（FIFO pipeline，类似链表的数据结构）处于不满状态（还能放进来）
             if (rw==WRITE) {  // 查看上一次访存操作是否为写入
@@ -276,12 +304,13 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
                rwq->set_min_length(m_config->CL);  // 设置rwq的最小长度（FIFO pipeline，FIFO流水线？）   新的最小长度 == CL（实际上就是读取的时延）
             }
             rwq->push(bk[j]->mrq);     // 将内存请求（mrq）放入rwq
+            m_rwq_cmds++;
             bk[j]->mrq->txbytes += m_config->dram_atom_size;   // + 每个“读”或“写”命令传输的字节数
-            CCDc = m_config->tCCD;                             // 重置：CCDc。“列选信号”切换的开销（花费的时间）
-            bkgrp[grp]->CCDLc = m_config->tCCDL;               // 重置：CCDLc。当bank的group有效时，从一个列选信号切换到另一个列选信号，所需要的时间 //column to column delay when bank groups are enabled 
-            RTWc = m_config->tRTW;  // 重置：RTWc。内存从“读取”状态转换到“写入”状态，所需要的时间（适用于所有bank）  /// read to write penalty applies across banks
-            bk[j]->RTPc = m_config->BL/m_config->data_command_freq_ratio;  // 重置：RTPc。同一bank中，从“读取”状态转为”预充电“状态的开销
-            bkgrp[grp]->RTPLc = m_config->tRTPL;      // 重置：RTPLc。bank group中，”读取“状态（数据总线）转为“预充电”（命令总线？）状态的开销
+            arm(CCD, m_config->tCCD);                          // 重置：CCDc。“列选信号”切换的开销（花费的时间）
+            bkgrp[grp]->CCDL = m_dram_cycle + m_config->tCCDL; // 重置：CCDLc。当bank的group有效时，从一个列选信号切换到另一个列选信号，所需要的时间 //column to column delay when bank groups are enabled 
+            arm(RTW, m_config->tRTW);  // 重置：RTWc。内存从“读取”状态转换到“写入”状态，所需要的时间（适用于所有bank）  /// read to write penalty applies across banks
+            bk[j]->RTP = m_dram_cycle + m_config->BL/m_config->data_command_freq_ratio;  // 重置：RTPc。同一bank中，从“读取”状态转为”预充电“状态的开销
+            bkgrp[grp]->RTPL = m_dram_cycle + m_config->tRTPL; // 重置：RTPLc。bank group中，”读取“状态（数据总线）转为“预充电”（命令总线？）状态的开销
             issued = true;    // 更改”发射“状态标志位（mrq已经发射出去）
             n_rd++;
             bwutil += m_config->BL/m_config->data_command_freq_ratio;   // （BL/data_command_freq_ratio）代表什么？bank的RTPc
@@ -296,13 +325,14 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
             // transfer done  判断传输是否完成： txbytes >= nbytes ， 表示传输完成了
             if ( !(bk[j]->mrq->txbytes < bk[j]->mrq->nbytes) ) {
                bk[j]->mrq = NULL;   // 将ID为j的bank中的访存请求mrq设置为空
+               m_busy_banks--;
             }
          } else
             // *************************************** 访存请求mrq的行为：”写入“，bank[j]处于激活状态，上一次的”行选信号“ == mrq的”行选信号“ /// correct row activated for a WRITE
-            if ( !issued && !CCDc && !bk[j]->RCDWRc &&      // 未发射 && CCDc == 0 && RCDWRc == 0
-                 !(bkgrp[grp]->CCDLc) &&                    // bank group的CCDLc == 0
+            if ( !issued && elapsed(CCD) && elapsed(bk[j]->RCDWR) && // 未发射 && CCDc == 0 && RCDWRc == 0
+                 elapsed(bkgrp[grp]->CCDL) &&               // bank group的CCDLc == 0
                  (bk[j]->curr_row == bk[j]->mrq->row)  &&   // 上次”行选信号“ == mrq(本次)”行选信号“（可以免去”行激活时间“）
-                 (bk[j]->mrq->rw == WRITE) && (RTWc == 0 )  && // mrq的操作为：”写入“ && RTWc == 0
+                 (bk[j]->mrq->rw == WRITE) && elapsed(RTW)  && // mrq的操作为：”写入“ && RTWc == 0
                  (bk[j]->state == BANK_ACTIVE) &&           // bank[j]处于激活状态
                  !rwq->full() ) {                           // rwq不满（FIFO pipeline，链表结构）
             if (rw==READ) {   // 判断上一次的DRAM channel的操作
@@ -310,12 +340,13 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
                rwq->set_min_length(m_config->WL);  // 设置rwq的最小长度。  新的最小长度 == 数据的写入时延
             }
             rwq->push(bk[j]->mrq);  // 访存请求mrq放入rwq（FIFO pipeline，链表）
+            m_rwq_cmds++;
 
             bk[j]->mrq->txbytes += m_config->dram_atom_size;   // 设置传输的数据大小（写入数据大小）
-            CCDc = m_config->tCCD;     // 重置DRAM channel的CCDc
-            bkgrp[grp]->CCDLc = m_config->tCCDL;   // 重置bank[j] 所在group的 tCCDL
-            WTRc = m_config->tWTR;     // 重置DRAM channel的WTRc
-            bk[j]->WTPc = m_config->tWTP;          // 重置bank[j]的WTPc
+            arm(CCD, m_config->tCCD);  // 重置DRAM channel的CCDc
+            bkgrp[grp]->CCDL = m_dram_cycle + m_config->tCCDL; // 重置bank[j] 所在group的 tCCDL
+            arm(WTR, m_config->tWTR);  // 重置DRAM channel的WTRc
+            bk[j]->WTP = m_dram_cycle + m_config->tWTP; // 重置bank[j]的WTPc
             issued = true;             // 访存请求发射完毕
             n_wr++;                    // 内存写入次数+1
             bwutil += m_config->BL/m_config->data_command_freq_ratio;         // 为什么要加上这个？”读取“状态转为”预充电“的开销（同一bank）
@@ -329,14 +360,15 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
             // transfer done 确认本次数据传输结束： 传输数据大小 >= mrq的”写入“数据大小
             if ( !(bk[j]->mrq->txbytes < bk[j]->mrq->nbytes) ) {
                bk[j]->mrq = NULL;   // 将bank[j]的访存请求置为NULL
+               m_busy_banks--;
             }
          }
 
          else
             // *************************************** bank[j]处于空闲状态 /// bank is idle /// 注：寻址分两步：（1）发出”bank的ID“与”行选信号“    （2）在“行选信号”就绪的情况下，再发”列选信号“完成寻址   
-            if ( !issued && !RRDc &&            // 未发射 && ”行选信号“之间的切换时延 == 0 （可以理解为：完成了“行选信号”的切换）
+            if ( !issued && elapsed(RRD) &&     // 未发射 && ”行选信号“之间的切换时延 == 0 （可以理解为：完成了“行选信号”的切换）
                  (bk[j]->state == BANK_IDLE) && // bank[j]处于空闲状态（未激活）
-                 !bk[j]->RPc && !bk[j]->RCc ) { // 行预充电时间 == 0（预充电完成） && 行循环时间 == 0 （理解一下，就是”行选信号“已经就绪了）
+                 elapsed(bk[j]->RP) && elapsed(bk[j]->RC) ) { // 行预充电时间 == 0（预充电完成） && 行循环时间 == 0 （理解一下，就是”行选信号“已经就绪了）
 #ifdef DRAM_VERIFY
             PRINT_CYCLE=1;
             printf("\tACT BK:%d NewRow:%03x From:%03x \n",
@@ -345,11 +377,11 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
             // 本次操作完成寻址的第一步   /// activate the row with current memory request 
             bk[j]->curr_row = bk[j]->mrq->row;  // 给出bank[j]的“激活行”
             bk[j]->state = BANK_ACTIVE;         // 更改bank[j]的状态
-            RRDc = m_config->tRRD;              // 重置：RRDc
-            bk[j]->RCDc = m_config->tRCD;       // 重置：RCDc
-            bk[j]->RCDWRc = m_config->tRCDWR;   // 重置：RCDWRc
-            bk[j]->RASc = m_config->tRAS;       // 重置：RASc
-            bk[j]->RCc = m_config->tRC;         // 重置：RCc
+            arm(RRD, m_config->tRRD);           // 重置：RRDc
+            arm(bk[j]->RCD, m_config->tRCD);    // 重置：RCDc
+            arm(bk[j]->RCDWR, m_config->tRCDWR);// 重置：RCDWRc
+            arm(bk[j]->RAS, m_config->tRAS);    // 重置：RASc
+            arm(bk[j]->RC, m_config->tRC);      // 重置：RCc
             prio = (j + 1) % m_config->nbk;     // 更新：上次操作的bank的ID
             issued = true;       // 更新发射状态
             n_act_partial++;     // 统计： DRAM channel的动作+1
@@ -361,12 +393,12 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
             if ( (!issued) &&    // 未发射
                  (bk[j]->curr_row != bk[j]->mrq->row) && // bank[j]中的“激活行” != mrq的”行选信号“ 
                  (bk[j]->state == BANK_ACTIVE) &&        // bank[j]处于激活状态
-                 (!bk[j]->RASc && !bk[j]->WTPc &&        // 关闭（猜测：关闭行 与 激活行 的开销一样）已经处于激活状态的bank中的行的时延 == 0 && ”写入“操作预充电完成
-				      !bk[j]->RTPc &&                        // “读取”操作的预充电完成
-				      !bkgrp[grp]->RTPLc) ) {                // bank group的”读取“预充电完成
+                 (elapsed(bk[j]->RAS) && elapsed(bk[j]->WTP) && // 关闭（猜测：关闭行 与 激活行 的开销一样）已经处于激活状态的bank中的行的时延 == 0 && ”写入“操作预充电完成
+				      elapsed(bk[j]->RTP) &&                 // “读取”操作的预充电完成
+				      elapsed(bkgrp[grp]->RTPL)) ) {                // bank group的”读取“预充电完成
             // make the bank idle again
             bk[j]->state = BANK_IDLE;        // 设置bank[j]的状态为：空闲
-            bk[j]->RPc = m_config->tRP;      // 重置bank的行预充电时间
+            arm(bk[j]->RP, m_config->tRP);   // 重置bank的行预充电时间
             prio = (j + 1) % m_config->nbk;  // 更新：上一次操作的bank的ID
             issued = true;    // 更改发射标志位
             n_pre++;          // 统计： 预处理+1
@@ -377,8 +409,8 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
 #endif
          }  // 回顾之前的四个分支： 1、执行mrq的”读取“操作  2、执行mrq的”写入“操作  3、mrq所在的bank处于空闲状态  4、mrq所在的bank的“激活行”不对，需要关闭bank（变为：空闲）
       } else {    // mrq是空的
-         if (!CCDc && !RRDc && !RTWc && !WTRc && !bk[j]->RCDc && !bk[j]->RASc
-             && !bk[j]->RCc && !bk[j]->RPc  && !bk[j]->RCDWRc) k--;
+         if (elapsed(CCD) && elapsed(RRD) && elapsed(RTW) && elapsed(WTR) && elapsed(bk[j]->RCD) && elapsed(bk[j]->RAS)
+             && elapsed(bk[j]->RC) && elapsed(bk[j]->RP)  && elapsed(bk[j]->RCDWR)) k--;
          bk[j]->n_idle++;  // 空闲的bank数量+1
       }
    }
@@ -396,24 +428,8 @@ void dram_t::cycle()    // DRAM channel的运行函数，整个DRAM的运行，
    n_cmd++;
    n_cmd_partial++;
 
-   // 每过一个DRAM channel的cycle，DRAM channel的以下时延-1（如果是0，就不用减）   /// decrements counters once for each time dram_issueCMD is called
-   DEC2ZERO(RRDc);   // RRDc--：不同的bank之间，”行选信号“之间的切换时延
-   DEC2ZERO(CCDc);   // CCDc--：同一bank内，”列选信号“之间的切换时延
-   DEC2ZERO(RTWc);   // RTWc--：DRAM channel的”读取“状态切换至”写入“状态的时延（惩罚）
-   DEC2ZERO(WTRc);   // WTRc--：DRAM channel的”写入“状态切换至”读取“状态的时延（惩罚）
-   for (unsigned j=0;j<m_config->nbk;j++) {        // 每过一个DRAM channel的cycle，所有bank的以下时延-1（如果是0，就不用减）
-      DEC2ZERO(bk[j]->RCDc);  // RCDc--：”列选信号“发出到所选列处于”激活“状态的时延（访存请求：”读取“）
-      DEC2ZERO(bk[j]->RASc);  // RASc--：”行选信号“发出到所选行处于”激活“状态的时延
-      DEC2ZERO(bk[j]->RCc);   // RCc--：关闭当前的”激活行“之后，再去激活“其他行”所需要的时间 （再去激活其他行的时间）
-      DEC2ZERO(bk[j]->RPc);   // RPc--：关闭当前的”激活行“所需要的时间
-      DEC2ZERO(bk[j]->RCDWRc);// RCDWRc：”列选信号“发出到所选列处于”激活“状态的时延（访存请求：”写入“）
-      DEC2ZERO(bk[j]->WTPc);  // WTPc--：bank从”写入“状态切换至”预充电“状态
-      DEC2ZERO(bk[j]->RTPc);  // RTPc--：bank从”读取“状态切换至”预充电“状态
-   }
-   for (unsigned j=0; j<m_config->nbkgrp; j++) {   // 每过一个DRAM channel的cycle，所有bank group的以下时延-1（如果是0，就不用减）
-	   DEC2ZERO(bkgrp[j]->CCDLc); // CCDLc--：当bank group使能有效时，”列选信号“之间切换的时延
-	   DEC2ZERO(bkgrp[j]->RTPLc); // RTPLc--：当bank group使能有效时，从”读取“状态切换至”预充电“状态的时延
-   }
+   // 时序约束以绝对时刻记录，推进时钟即可，无需逐个计数器减1   /// timing constraints are absolute, advancing the clock retires them
+   m_dram_cycle++;
 
 #ifdef DRAM_VISUALIZE
    visualize();
@@ -444,7 +460,7 @@ void dram_t::print( FILE* simFile) const
    fprintf(simFile,"n_activity=%d dram_eff=%.4g\n",
            n_activity, (float)bwutil/n_activity);
    for (i=0;i<m_config->nbk;i++) {
-      fprintf(simFile, "bk%d: %da %di ",i,bk[i]->n_access,bk[i]->n_idle);
+      fprintf(simFile, "bk%d: %da %di ",i,bk[i]->n_access,bk[i]->n_idle+m_idle_cycles);
    }
    fprintf(simFile, "\n");
    fprintf(simFile, "dram_util_bins:");
@@ -459,12 +475,12 @@ void dram_t::print( FILE* simFile) const
 void dram_t::visualize() const
 {
    printf("RRDc=%d CCDc=%d mrqq.Length=%d rwq.Length=%d\n", 
-          RRDc, CCDc, mrqq->get_length(),rwq->get_length());
+          remaining(RRD), remaining(CCD), mrqq->get_length(),rwq->get_length());
    for (unsigned i=0;i<m_config->nbk;i++) {
       printf("BK%d: state=%c curr_row=%03x, %2d %2d %2d %2d %p ", 
              i, bk[i]->state, bk[i]->curr_row,
-             bk[i]->RCDc, bk[i]->RASc,
-             bk[i]->RPc, bk[i]->RCc,
+             remaining(bk[i]->RCD), remaining(bk[i]->RAS),
+             remaining(bk[i]->RP), remaining(bk[i]->RC),
              bk[i]->mrq );
       if (bk[i]->mrq)
          printf("txf: %d %d", bk[i]->mrq->nbytes, bk[i]->mrq->txbytes);
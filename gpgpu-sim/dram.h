@@ -58,21 +58,24 @@ public:
    class mem_fetch * data;
 };
 
+// Timing constraints are kept as the absolute DRAM cycle (dram_t::m_dram_cycle)
+// at which they expire instead of counters decremented every cycle; a
+// constraint X is satisfied when m_dram_cycle >= X.
 struct bankgrp_t
 {
-	unsigned int CCDLc;  // 当bank的group有效时，从一个列选信号切换到另一个列选信号，所需要的时间 //column to column delay when bank groups are enabled 
-	unsigned int RTPLc;  // “读取”操作的预充电时延                                         //read to precharge delay when bank groups are enabled for GDDR5 this is identical to RTPS, if for other DRAM this is different, you will need to split them in two
+	unsigned long long CCDL;  // 当bank的group有效时，从一个列选信号切换到另一个列选信号，所需要的时间 //column to column delay when bank groups are enabled 
+	unsigned long long RTPL;  // “读取”操作的预充电时延                                         //read to precharge delay when bank groups are enabled for GDDR5 this is identical to RTPS, if for other DRAM this is different, you will need to split them in two
 };
 
 struct bank_t
 {
-   unsigned int RCDc;   // 执行“读取”操作时，从“行选信号”处于激活状态开始，到“列选信号”处于激活状态，所需要的时间（注：“行选信号”与“bank的ID”先行传输，等“行选信号”选中的行处于激活状态之后，才发出“列选信号”） // row to column delay - time required to activate a row before a read
-   unsigned int RCDWRc; // 执行“写入”操作时，从“行选信号”处于激活状态开始，到“列选信号”处于激活状态，所需要的时间 //row to column delay for a write command
-   unsigned int RASc;   // 激活“行选信号”所选中的行，花费的时间     //time needed to activate row
-   unsigned int RPc;    // 行预充电时间（即：关闭“行选信号”选中的行所需要的时间），这里默认是在同一bank内的行之间的切换（L-Bank关闭现有工作行，准备打开新行的操作就是预充电（Precharge）。） // row precharge ie. deactivate row
-   unsigned int RCc;    // 行循环时间（即：关闭之后，再激活不同行，所花费的时间） // row cycle time ie. precharge current, then activate different row
-   unsigned int WTPc; // write to precharge  //time to switch from write to precharge in the same bank
-   unsigned int RTPc; // read to precharge   //time to switch from read to precharge in the same bank
+   unsigned long long RCD;   // 执行“读取”操作时，从“行选信号”处于激活状态开始，到“列选信号”处于激活状态，所需要的时间（注：“行选信号”与“bank的ID”先行传输，等“行选信号”选中的行处于激活状态之后，才发出“列选信号”） // row to column delay - time required to activate a row before a read
+   unsigned long long RCDWR; // 执行“写入”操作时，从“行选信号”处于激活状态开始，到“列选信号”处于激活状态，所需要的时间 //row to column delay for a write command
+   unsigned long long RAS;   // 激活“行选信号”所选中的行，花费的时间     //time needed to activate row
+   unsigned long long RP;    // 行预充电时间（即：关闭“行选信号”选中的行所需要的时间），这里默认是在同一bank内的行之间的切换（L-Bank关闭现有工作行，准备打开新行的操作就是预充电（Precharge）。） // row precharge ie. deactivate row
+   unsigned long long RC;    // 行循环时间（即：关闭之后，再激活不同行，所花费的时间） // row cycle time ie. precharge current, then activate different row
+   unsigned long long WTP; // write to precharge  //time to switch from write to precharge in the same bank
+   unsigned long long RTP; // read to precharge   //time to switch from read to precharge in the same bank
 
    unsigned char rw;    // bank的读写状态 （读取or写入）   /// is the bank reading or writing?   
    unsigned char state; // bank的执行状态（活跃or空闲）    /// is the bank active or idle?
@@ -89,13 +92,51 @@ struct bank_t
 
 struct mem_fetch;
 
-class dram_t 
+// Interface between a memory partition and the DRAM channel behind it. The
+// model is chosen per run with -gpgpu_dram_model (see create_dram_backend()).
+class dram_backend
+{
+public:
+   virtual ~dram_backend() {}
+
+   // full(): conservative, some request might not be accepted; full(mf): mf cannot be
+   virtual bool full() const = 0;
+   virtual bool full( const class mem_fetch *mf ) const = 0;
+   virtual void push( class mem_fetch *data ) = 0;
+   virtual void cycle() = 0;
+   virtual class mem_fetch* return_queue_top() = 0;
+   virtual class mem_fetch* return_queue_pop() = 0;
+   virtual unsigned que_length() const = 0;
+
+   virtual void print( FILE* simFile ) const = 0;
+   virtual void visualize() const = 0;
+   virtual void print_stat( FILE* simFile ) = 0;
+   virtual void visualizer_print( gzFile visualizer_file ) = 0;
+   virtual void dram_log( int task ) = 0;
+
+   // Power Model
+   virtual void set_dram_power_stats(unsigned &cmd,
+                                     unsigned &activity,
+                                     unsigned &nop,
+                                     unsigned &act,
+                                     unsigned &pre,
+                                     unsigned &rd,
+                                     unsigned &wr,
+                                     unsigned &req) const = 0;
+};
+
+dram_backend *create_dram_backend( unsigned int partition_id, const struct memory_config *config, 
+                                   class memory_stats_t *stats, class memory_partition_unit *mp );
+
+// command accurate DDR/GDDR channel model
+class dram_t : public dram_backend
 {
 public:
    dram_t( unsigned int parition_id, const struct memory_config *config, class memory_stats_t *stats, 
            class memory_partition_unit *mp );
 
    bool full() const;
+   bool full( const class mem_fetch *mf ) const { return full(); }
    void print( FILE* simFile ) const;
    void visualize() const;
    void print_stat( FILE* simFile );
@@ -126,6 +167,16 @@ public:
 private:
    void scheduler_fifo();
    void scheduler_frfcfs();
+   void idle_cycle();
+
+   bool elapsed( unsigned long long t ) const { return m_dram_cycle >= t; }
+   unsigned remaining( unsigned long long t ) const { return elapsed(t)? 0 : (unsigned)(t - m_dram_cycle); }
+   // arm a constraint that also keeps the channel counted as active (n_activity)
+   void arm( unsigned long long &t, unsigned delay ) 
+   { 
+      t = m_dram_cycle + delay; 
+      if (t > m_quiet_at) m_quiet_at = t; 
+   }
 
    const struct memory_config *m_config;
 
@@ -134,10 +185,16 @@ private:
    bank_t **bk;
    unsigned int prio;
 
-   unsigned int RRDc;   // 不同的bank之间，切换“行选信号”所花费的最短时间   //minimal time required between activation of rows in different banks
-   unsigned int CCDc;   // ”列选信号“之间的切换开销 //column to column delay
-   unsigned int RTWc;   // 内存从“读取”状态转换到“写入”状态，所需要的时间（适用于所有bank）  /// read to write penalty applies across banks
-   unsigned int WTRc;   // 内存从“写入”状态转换到“读取”状态，所需要的时间（适用于所有bank）  /// write to read penalty applies across banks
+   unsigned long long RRD;   // 不同的bank之间，切换“行选信号”所花费的最短时间   //minimal time required between activation of rows in different banks
+   unsigned long long CCD;   // ”列选信号“之间的切换开销 //column to column delay
+   unsigned long long RTW;   // 内存从“读取”状态转换到“写入”状态，所需要的时间（适用于所有bank）  /// read to write penalty applies across banks
+   unsigned long long WTR;   // 内存从“写入”状态转换到“读取”状态，所需要的时间（适用于所有bank）  /// write to read penalty applies across banks
+
+   unsigned long long m_dram_cycle; // DRAM cycles elapsed on this channel
+   unsigned long long m_quiet_at;   // all activity-relevant constraints expire at this cycle
+   unsigned int m_busy_banks;       // banks currently holding a request (bk[]->mrq)
+   unsigned int m_rwq_cmds;         // column commands in rwq (get_n_element() does not count all of them)
+   unsigned int m_idle_cycles;      // cycles skipped by idle_cycle(); counted as n_idle on every bank
 
    unsigned char rw; // 记录最后一次的访存请求（是“读取”or“写入”）   /// was last request a read or write? (important for RTW, WTR)
 
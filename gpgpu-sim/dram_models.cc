@@ -0,0 +1,360 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "dram_models.h"
+#include "gpu-sim.h"
+#include "gpu-misc.h"
+#include "mem_latency_stat.h"
+#include "mem_fetch.h"
+#include "l2cache.h"
+#include "../statwrapper.h"
+
+dram_backend *create_dram_backend( unsigned int partition_id, const struct memory_config *config,
+                                   class memory_stats_t *stats, class memory_partition_unit *mp )
+{
+   switch (config->dram_model) {
+   case DRAM_MODEL_GDDR: return new dram_t(partition_id,config,stats,mp);
+   case DRAM_MODEL_HBM2: return new hbm2_dram(partition_id,config,stats,mp);
+   case DRAM_MODEL_FIXED: return new fixed_latency_dram(partition_id,config,stats,mp);
+   default:
+      printf("GPGPU-Sim uArch: ERROR unknown DRAM model %d (-gpgpu_dram_model)\n", config->dram_model);
+      abort();
+   }
+   return NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+hbm2_dram::hbm2_dram( unsigned int partition_id, const struct memory_config *config, class memory_stats_t *stats,
+                      class memory_partition_unit *mp )
+{
+   id = partition_id;
+   m_pc_config = new memory_config(*config);
+   m_pc_config->busW = config->busW / N_PSEUDO_CHANNELS;
+   m_pc_config->dram_atom_size = m_pc_config->BL * m_pc_config->busW * m_pc_config->gpu_n_mem_per_ctrlr;
+   // the queue sizes are per channel: split them so that the channel as a 
+   // whole buffers what was configured (0 = unlimited stays unlimited, an 
+   // unlimited return queue is 1024 entries in dram_t)
+   if (config->gpgpu_frfcfs_dram_sched_queue_size)
+      m_pc_config->gpgpu_frfcfs_dram_sched_queue_size = (config->gpgpu_frfcfs_dram_sched_queue_size + 1) / N_PSEUDO_CHANNELS;
+   m_pc_config->gpgpu_dram_return_queue_size = 
+      (config->gpgpu_dram_return_queue_size? config->gpgpu_dram_return_queue_size : 1024) / N_PSEUDO_CHANNELS;
+   if (m_pc_config->gpgpu_dram_return_queue_size == 0)
+      m_pc_config->gpgpu_dram_return_queue_size = 1;
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      m_pc[p] = new dram_t(partition_id,m_pc_config,stats,mp);
+   m_return_prio = 0;
+   m_return_sel = 0;
+}
+
+hbm2_dram::~hbm2_dram()
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      delete m_pc[p];
+   delete m_pc_config;
+}
+
+// conservative check for the partition's L2->DRAM admission, which happens 
+// before the request is picked: either pseudo-channel being full stalls it
+bool hbm2_dram::full() const
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      if (m_pc[p]->full())
+         return true;
+   return false;
+}
+
+// the pseudo-channels are independent: a request only waits for its own
+bool hbm2_dram::full( const mem_fetch *mf ) const
+{
+   return m_pc[mf->get_tlx_addr().bk % N_PSEUDO_CHANNELS]->full();
+}
+
+void hbm2_dram::push( class mem_fetch *data )
+{
+   m_pc[data->get_tlx_addr().bk % N_PSEUDO_CHANNELS]->push(data);
+}
+
+void hbm2_dram::cycle()
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      m_pc[p]->cycle();
+}
+
+mem_fetch* hbm2_dram::return_queue_top()
+{
+   for (unsigned i=0; i < N_PSEUDO_CHANNELS; i++) {
+      unsigned p = (m_return_prio + i) % N_PSEUDO_CHANNELS;
+      mem_fetch *mf = m_pc[p]->return_queue_top();
+      if (mf) {
+         m_return_sel = p;
+         return mf;
+      }
+   }
+   m_return_sel = m_return_prio;
+   return NULL;
+}
+
+mem_fetch* hbm2_dram::return_queue_pop()
+{
+   mem_fetch *mf = m_pc[m_return_sel]->return_queue_pop();
+   if (mf)
+      m_return_prio = (m_return_sel + 1) % N_PSEUDO_CHANNELS;
+   return mf;
+}
+
+unsigned hbm2_dram::que_length() const
+{
+   unsigned n = 0;
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      n += m_pc[p]->que_length();
+   return n;
+}
+
+void hbm2_dram::print( FILE* simFile ) const
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++) {
+      fprintf(simFile,"DRAM[%d] pseudo-channel %u:\n", id, p);
+      m_pc[p]->print(simFile);
+   }
+}
+
+void hbm2_dram::visualize() const
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++) {
+      printf("pseudo-channel %u: ", p);
+      m_pc[p]->visualize();
+   }
+}
+
+void hbm2_dram::print_stat( FILE* simFile )
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++) {
+      fprintf(simFile,"pseudo-channel %u: ", p);
+      m_pc[p]->print_stat(simFile);
+   }
+}
+
+void hbm2_dram::visualizer_print( gzFile visualizer_file )
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      m_pc[p]->visualizer_print(visualizer_file);
+}
+
+void hbm2_dram::dram_log( int task )
+{
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++)
+      m_pc[p]->dram_log(task);
+}
+
+// both pseudo-channels run on the channel clock; counters add up
+void hbm2_dram::set_dram_power_stats( unsigned &cmd, unsigned &activity, unsigned &nop, unsigned &act,
+                                      unsigned &pre, unsigned &rd, unsigned &wr, unsigned &req ) const
+{
+   cmd = activity = nop = act = pre = rd = wr = req = 0;
+   for (unsigned p=0; p < N_PSEUDO_CHANNELS; p++) {
+      unsigned c, a, n, ac, pr, r, w, q;
+      m_pc[p]->set_dram_power_stats(c, a, n, ac, pr, r, w, q);
+      cmd += c;
+      activity += a;
+      nop += n;
+      act += ac;
+      pre += pr;
+      rd += r;
+      wr += w;
+      req += q;
+   }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+fixed_latency_dram::fixed_latency_dram( unsigned int partition_id, const struct memory_config *config,
+                                        class memory_stats_t *stats, class memory_partition_unit *mp )
+{
+   id = partition_id;
+   m_config = config;
+   m_stats = stats;
+   m_memory_partition_unit = mp;
+   returnq = new fifo_pipeline<mem_fetch>("dramreturnq",0,m_config->gpgpu_dram_return_queue_size==0?1024:m_config->gpgpu_dram_return_queue_size);
+   m_dram_cycle = 0;
+   m_bus_free_at = 0;
+   n_cmd = n_activity = n_nop = 0;
+   n_rd = n_wr = n_req = 0;
+   bwutil = 0;
+   max_mrqs = 0;
+   ave_mrqs = 0;
+   n_cmd_partial = n_activity_partial = n_req_partial = bwutil_partial = 0;
+   if ( m_config->gpgpu_frfcfs_dram_sched_queue_size )
+      mrqq_Dist = StatCreate("mrqq_length",1, m_config->gpgpu_frfcfs_dram_sched_queue_size);
+   else //queue length is unlimited;
+      mrqq_Dist = StatCreate("mrqq_length",1,64); //track up to 64 entries
+}
+
+fixed_latency_dram::~fixed_latency_dram()
+{
+   delete returnq;
+}
+
+bool fixed_latency_dram::full() const
+{
+   if (m_config->gpgpu_frfcfs_dram_sched_queue_size == 0) return false;
+   return m_pending.size() >= m_config->gpgpu_frfcfs_dram_sched_queue_size;
+}
+
+void fixed_latency_dram::push( class mem_fetch *data )
+{
+   assert(id == data->get_tlx_addr().chip);
+   data->set_status(IN_PARTITION_DRAM,gpu_sim_cycle+gpu_tot_sim_cycle);
+
+   // every atom occupies the data bus for one burst, as in dram_t
+   unsigned atoms = (data->get_data_size() + m_config->dram_atom_size - 1) / m_config->dram_atom_size;
+   if (atoms == 0) atoms = 1;
+   unsigned burst = m_config->BL/m_config->data_command_freq_ratio;
+   unsigned long long start = (m_bus_free_at > m_dram_cycle)? m_bus_free_at : m_dram_cycle;
+   m_bus_free_at = start + atoms * burst;
+   pending_req r;
+   r.data = data;
+   r.ready_cycle = m_bus_free_at + m_config->dram_fixed_latency;
+   m_pending.push_back(r);
+
+   n_req++;
+   n_req_partial++;
+   if (data->get_is_write()) {
+      n_wr += atoms;
+      m_stats->total_n_writes++;
+   } else {
+      n_rd += atoms;
+      m_stats->total_n_reads++;
+   }
+   m_stats->total_n_access++;
+   m_stats->memlatstat_dram_access(data);
+}
+
+void fixed_latency_dram::cycle()
+{
+   if ( !returnq->full() && !m_pending.empty() && m_pending.front().ready_cycle <= m_dram_cycle ) {
+      mem_fetch *data = m_pending.front().data;
+      m_pending.pop_front();
+      data->set_status(IN_PARTITION_MC_RETURNQ,gpu_sim_cycle+gpu_tot_sim_cycle);
+      if( data->get_access_type() != L1_WRBK_ACC && data->get_access_type() != L2_WRBK_ACC ) {
+         data->set_reply();
+         returnq->push(data);
+      } else {
+         m_memory_partition_unit->set_done(data);
+         delete data;
+      }
+   }
+
+   unsigned nreqs = m_pending.size();
+   if (nreqs > max_mrqs)
+      max_mrqs = nreqs;
+   ave_mrqs += nreqs;
+   if (m_bus_free_at > m_dram_cycle) {
+      bwutil++;
+      bwutil_partial++;
+   } else {
+      n_nop++;
+   }
+   if (nreqs) {
+      n_activity++;
+      n_activity_partial++;
+   }
+   n_cmd++;
+   n_cmd_partial++;
+   m_dram_cycle++;
+}
+
+mem_fetch* fixed_latency_dram::return_queue_top()
+{
+   return returnq->top();
+}
+
+mem_fetch* fixed_latency_dram::return_queue_pop()
+{
+   return returnq->pop();
+}
+
+void fixed_latency_dram::print( FILE* simFile ) const
+{
+   fprintf(simFile,"DRAM[%d]: fixed latency=%u busW=%d BL=%d\n",
+           id, m_config->dram_fixed_latency, m_config->busW, m_config->BL);
+   fprintf(simFile,"n_cmd=%d n_nop=%d n_req=%d n_rd=%d n_write=%d bw_util=%.4g\n",
+           n_cmd, n_nop, n_req, n_rd, n_wr, (float)bwutil/n_cmd);
+   fprintf(simFile,"n_activity=%d dram_eff=%.4g\n",
+           n_activity, (float)bwutil/n_activity);
+   fprintf(simFile, "mrqq: max=%d avg=%g\n", max_mrqs, (float)ave_mrqs/n_cmd);
+}
+
+void fixed_latency_dram::visualize() const
+{
+   printf("DRAM[%d]: pending=%zu bus free in %llu\n", id, m_pending.size(),
+          (m_bus_free_at > m_dram_cycle)? m_bus_free_at - m_dram_cycle : 0ULL);
+}
+
+void fixed_latency_dram::print_stat( FILE* simFile )
+{
+   fprintf(simFile,"DRAM (%d): n_cmd=%d n_nop=%d n_req=%d n_rd=%d n_write=%d bw_util=%.4g ",
+           id, n_cmd, n_nop, n_req, n_rd, n_wr, (float)bwutil/n_cmd);
+   fprintf(simFile, "mrqq: %d %.4g\n", max_mrqs, (float)ave_mrqs/n_cmd);
+}
+
+void fixed_latency_dram::visualizer_print( gzFile visualizer_file )
+{
+   gzprintf(visualizer_file,"dramncmd: %u %u\n",id, n_cmd_partial);
+   gzprintf(visualizer_file,"dramnreq: %u %u\n",id,n_req_partial);
+   gzprintf(visualizer_file,"dramutil: %u %u\n",
+            id,n_cmd_partial?100*bwutil_partial/n_cmd_partial:0);
+   gzprintf(visualizer_file,"drameff: %u %u\n",
+            id,n_activity_partial?100*bwutil_partial/n_activity_partial:0);
+   bwutil_partial = 0;
+   n_activity_partial = 0;
+   n_cmd_partial = 0;
+   n_req_partial = 0;
+}
+
+void fixed_latency_dram::dram_log( int task )
+{
+   if (task == SAMPLELOG) {
+      StatAddSample(mrqq_Dist, que_length());
+   } else if (task == DUMPLOG) {
+      printf ("Queue Length DRAM[%d] ",id);StatDisp(mrqq_Dist);
+   }
+}
+
+// no activates or precharges are modeled
+void fixed_latency_dram::set_dram_power_stats( unsigned &cmd, unsigned &activity, unsigned &nop, unsigned &act,
+                                               unsigned &pre, unsigned &rd, unsigned &wr, unsigned &req ) const
+{
+   cmd = n_cmd;
+   activity = n_activity;
+   nop = n_nop;
+   act = 0;
+   pre = 0;
+   rd = n_rd;
+   wr = n_wr;
+   req = n_req;
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DRAM_MODELS_H
+#define DRAM_MODELS_H
+
+#include "dram.h"
+#include <deque>
+
+// HBM2 style channel in pseudo-channel mode: the channel is split into two
+// pseudo-channels, each with half of the data bus and its own command
+// scheduling, sharing the channel's request and return paths. Banks are
+// interleaved between the pseudo-channels (bank bit 0), so each one is a
+// dram_t running the configured timing on a half width bus.
+class hbm2_dram : public dram_backend
+{
+public:
+   hbm2_dram( unsigned int partition_id, const struct memory_config *config, class memory_stats_t *stats,
+              class memory_partition_unit *mp );
+   ~hbm2_dram();
+
+   bool full() const;
+   bool full( const class mem_fetch *mf ) const;
+   void push( class mem_fetch *data );
+   void cycle();
+   class mem_fetch* return_queue_top();
+   class mem_fetch* return_queue_pop();
+   unsigned que_length() const;
+
+   void print( FILE* simFile ) const;
+   void visualize() const;
+   void print_stat( FILE* simFile );
+   void visualizer_print( gzFile visualizer_file );
+   void dram_log( int task );
+
+   void set_dram_power_stats(unsigned &cmd,
+                             unsigned &activity,
+                             unsigned &nop,
+                             unsigned &act,
+                             unsigned &pre,
+                             unsigned &rd,
+                             unsigned &wr,
+                             unsigned &req) const;
+
+private:
+   static const unsigned N_PSEUDO_CHANNELS = 2;
+
+   unsigned int id;
+   struct memory_config *m_pc_config;    // channel config with the pseudo-channel bus width
+   dram_t *m_pc[N_PSEUDO_CHANNELS];
+   unsigned m_return_prio;               // round robin between pseudo-channel return queues
+   unsigned m_return_sel;                // pseudo-channel picked by the last return_queue_top()
+};
+
+// Fixed latency, bandwidth limited channel: every request holds the data bus
+// for its bursts and returns dram_fixed_latency cycles after its last burst.
+// No bank, row or read/write turnaround state is modeled.
+class fixed_latency_dram : public dram_backend
+{
+public:
+   fixed_latency_dram( unsigned int partition_id, const struct memory_config *config, class memory_stats_t *stats,
+                       class memory_partition_unit *mp );
+   ~fixed_latency_dram();
+
+   bool full() const;
+   bool full( const class mem_fetch *mf ) const { return full(); }
+   void push( class mem_fetch *data );
+   void cycle();
+   class mem_fetch* return_queue_top();
+   class mem_fetch* return_queue_pop();
+   unsigned que_length() const { return m_pending.size(); }
+
+   void print( FILE* simFile ) const;
+   void visualize() const;
+   void print_stat( FILE* simFile );
+   void visualizer_print( gzFile visualizer_file );
+   void dram_log( int task );
+
+   void set_dram_power_stats(unsigned &cmd,
+                             unsigned &activity,
+                             unsigned &nop,
+                             unsigned &act,
+                             unsigned &pre,
+                             unsigned &rd,
+                             unsigned &wr,
+                             unsigned &req) const;
+
+private:
+   struct pending_req {
+      class mem_fetch *data;
+      unsigned long long ready_cycle;
+   };
+
+   unsigned int id;
+   const struct memory_config *m_config;
+   class memory_stats_t *m_stats;
+   class memory_partition_unit *m_memory_partition_unit;
+
+   std::deque<pending_req> m_pending;    // ready_cycle is non-decreasing
+   fifo_pipeline<mem_fetch> *returnq;
+   unsigned long long m_dram_cycle;
+   unsigned long long m_bus_free_at;     // first cycle the data bus is free
+
+   unsigned int n_cmd;
+   unsigned int n_activity;
+   unsigned int n_nop;
+   unsigned int n_rd;
+   unsigned int n_wr;
+   unsigned int n_req;
+   unsigned int bwutil;
+   unsigned int max_mrqs;
+   unsigned long long ave_mrqs;
+
+   unsigned int n_cmd_partial;
+   unsigned int n_activity_partial;
+   unsigned int n_req_partial;
+   unsigned int bwutil_partial;
+
+   class Stats* mrqq_Dist;
+};
+
+#endif
@@ -37,27 +37,131 @@ frfcfs_scheduler::frfcfs_scheduler( const memory_config *config, dram_t *dm, mem
    m_stats = stats;
    m_num_pending = 0;   // 初始化为0
    m_dram = dm;
-   m_queue = new std::list<dram_req_t*>[m_config->nbk];  // 根据bank的数量，生成list数组，保存dram_req_t
-   m_bins = new std::map<unsigned, std::list<std::list<dram_req_t*>::iterator> >[ m_config->nbk ]; // 映射，根据bank的ID号，映射到一个存放dram_req_t的二维数组，第一维：访问的行号
-   m_last_row = new std::list<std::list<dram_req_t*>::iterator>*[ m_config->nbk ];  // 根据bank的数量生成二维list
+   // 每个bank：按行号哈希的行队列（row bin）+ 按到达顺序的年龄链表
+   unsigned bins = 8;
+   unsigned expected = m_config->gpgpu_frfcfs_dram_sched_queue_size ? m_config->gpgpu_frfcfs_dram_sched_queue_size : 16;
+   while ( bins < 2*expected ) 
+      bins <<= 1;
+   m_banks = new bank_queue[m_config->nbk];
    curr_row_service_time = new unsigned[m_config->nbk];  // 根据bank的数量生成数组，统计每个bank，当前行的服务时间
    row_service_timestamp = new unsigned[m_config->nbk];  // 根据bank的数量生成数组，统计每个bank，当前行的开始服务时间
    for ( unsigned i=0; i < m_config->nbk; i++ ) {
-      m_queue[i].clear();
-      m_bins[i].clear();
-      m_last_row[i] = NULL;
+      row_bin empty = { 0, NIL, NIL };
+      m_banks[i].bins.assign( bins, empty );
+      m_banks[i].num_bins = 0;
+      m_banks[i].newest = NIL;
+      m_banks[i].oldest = NIL;
+      m_banks[i].length = 0;
+      m_banks[i].row_open = false;
+      m_banks[i].open_row = 0;
       curr_row_service_time[i] = 0;
       row_service_timestamp[i] = 0;
    }
+   m_nodes.reserve( expected * m_config->nbk );
+   m_free_node = NIL;
+}
+
+static inline unsigned row_hash( unsigned row, unsigned mask )
+{
+   return (row * 0x9E3779B1u) & mask;
+}
+
+unsigned frfcfs_scheduler::find_bin( const bank_queue &b, unsigned row ) const
+{
+   unsigned mask = b.bins.size() - 1;
+   for ( unsigned s = row_hash(row,mask); ; s = (s+1) & mask ) {
+      if ( b.bins[s].head == NIL ) 
+         return NIL;
+      if ( b.bins[s].row == row ) 
+         return s;
+   }
+}
+
+unsigned frfcfs_scheduler::insert_bin( bank_queue &b, unsigned row )
+{
+   if ( 2*(b.num_bins+1) > b.bins.size() ) 
+      grow_bins(b);
+   unsigned mask = b.bins.size() - 1;
+   unsigned s = row_hash(row,mask);
+   while ( b.bins[s].head != NIL ) 
+      s = (s+1) & mask;
+   b.bins[s].row = row;
+   b.num_bins++;
+   return s;
+}
+
+// backward shift deletion keeps probe sequences intact without tombstones
+void frfcfs_scheduler::erase_bin( bank_queue &b, unsigned slot )
+{
+   unsigned mask = b.bins.size() - 1;
+   unsigned hole = slot;
+   for ( unsigned s = (slot+1) & mask; b.bins[s].head != NIL; s = (s+1) & mask ) {
+      unsigned home = row_hash(b.bins[s].row,mask);
+      if ( ((s - home) & mask) >= ((s - hole) & mask) ) {
+         b.bins[hole] = b.bins[s];
+         hole = s;
+      }
+   }
+   b.bins[hole].head = NIL;
+   b.bins[hole].tail = NIL;
+   b.num_bins--;
+}
 
+void frfcfs_scheduler::grow_bins( bank_queue &b )
+{
+   std::vector<row_bin> old;
+   old.swap( b.bins );
+   row_bin empty = { 0, NIL, NIL };
+   b.bins.assign( 2*old.size(), empty );
+   unsigned mask = b.bins.size() - 1;
+   for ( unsigned i=0; i < old.size(); i++ ) {
+      if ( old[i].head == NIL ) 
+         continue;
+      unsigned s = row_hash(old[i].row,mask);
+      while ( b.bins[s].head != NIL ) 
+         s = (s+1) & mask;
+      b.bins[s] = old[i];
+   }
+}
+
+unsigned frfcfs_scheduler::alloc_node( dram_req_t *req )
+{
+   unsigned n = m_free_node;
+   if ( n == NIL ) {
+      n = m_nodes.size();
+      m_nodes.push_back( sched_node() );
+   } else {
+      m_free_node = m_nodes[n].row_next;
+   }
+   m_nodes[n].req = req;
+   m_nodes[n].older = NIL;
+   m_nodes[n].newer = NIL;
+   m_nodes[n].row_next = NIL;
+   return n;
 }
 
 void frfcfs_scheduler::add_req( dram_req_t *req )  // 增加访存请求dram_req_t
 {
    m_num_pending++;  // 记录访存数量
-   m_queue[req->bk].push_front(req);   // list，根据bank编号(req->bk)，按照先来先服务顺序，存放请求req
-   std::list<dram_req_t*>::iterator ptr = m_queue[req->bk].begin();  // 取出req->bk列表的第一个元素（请求）
-   m_bins[req->bk][req->row].push_front( ptr ); // 将最新的请求放入 //newest reqs to the front
+   bank_queue &b = m_banks[req->bk];
+   unsigned n = alloc_node(req);
+   // 年龄链表：最新的请求放在newest一端 //newest reqs to the front
+   m_nodes[n].older = b.newest;
+   if ( b.newest != NIL ) 
+      m_nodes[b.newest].newer = n;
+   else 
+      b.oldest = n;
+   b.newest = n;
+   b.length++;
+   // 行队列：同一行的请求按到达顺序排在队尾
+   unsigned slot = find_bin( b, req->row );
+   if ( slot == NIL ) {
+      slot = insert_bin( b, req->row );
+      b.bins[slot].head = n;
+   } else {
+      m_nodes[b.bins[slot].tail].row_next = n;
+   }
+   b.bins[slot].tail = n;
 }
 
 void frfcfs_scheduler::data_collection(unsigned int bank)
@@ -78,34 +182,47 @@ void frfcfs_scheduler::data_collection(unsigned int bank)
 
 dram_req_t *frfcfs_scheduler::schedule( unsigned bank, unsigned curr_row ) // FRFCFS的调度算法
 {
-   if ( m_last_row[bank] == NULL ) {   // 查看上一次（现在还处于激活状态）的行，其bank地址，为空，表示
-      if ( m_queue[bank].empty() )     // 查看
+   bank_queue &b = m_banks[bank];
+   if ( !b.row_open ) {   // 当前没有正在服务的行
+      if ( b.length == 0 ) 
          return NULL;
 
-      std::map<unsigned,std::list<std::list<dram_req_t*>::iterator> >::iterator bin_ptr = m_bins[bank].find( curr_row );
-      if ( bin_ptr == m_bins[bank].end()) {
-         dram_req_t *req = m_queue[bank].back();
-         bin_ptr = m_bins[bank].find( req->row );
-         assert( bin_ptr != m_bins[bank].end() ); // where did the request go???
-         m_last_row[bank] = &(bin_ptr->second);
+      if ( find_bin( b, curr_row ) == NIL ) {
+         // 没有命中已打开行的请求：选择最老的请求所在的行
+         b.open_row = m_nodes[b.oldest].req->row;
          data_collection(bank);
       } else {
-         m_last_row[bank] = &(bin_ptr->second);
-
+         b.open_row = curr_row;
       }
+      b.row_open = true;
    }
-   std::list<dram_req_t*>::iterator next = m_last_row[bank]->back();
-   dram_req_t *req = (*next);
+   unsigned slot = find_bin( b, b.open_row );
+   assert( slot != NIL ); // where did the request go???
+   unsigned n = b.bins[slot].head;
+   dram_req_t *req = m_nodes[n].req;
 
    m_stats->concurrent_row_access[m_dram->id][bank]++;
    m_stats->row_access[m_dram->id][bank]++;
-   m_last_row[bank]->pop_back();
-
-   m_queue[bank].erase(next);
-   if ( m_last_row[bank]->empty() ) {
-      m_bins[bank].erase( req->row );
-      m_last_row[bank] = NULL;
+   b.bins[slot].head = m_nodes[n].row_next;
+   if ( b.bins[slot].head == NIL ) {
+      erase_bin( b, slot );
+      b.row_open = false;
    }
+
+   // 从年龄链表中摘除，并归还节点
+   sched_node &node = m_nodes[n];
+   if ( node.older != NIL ) 
+      m_nodes[node.older].newer = node.newer;
+   else 
+      b.oldest = node.newer;
+   if ( node.newer != NIL ) 
+      m_nodes[node.newer].older = node.older;
+   else 
+      b.newest = node.older;
+   b.length--;
+   node.req = NULL;
+   node.row_next = m_free_node;
+   m_free_node = n;
 #ifdef DEBUG_FAST_IDEAL_SCHED
    if ( req )
       printf("%08u : DRAM(%u) scheduling memory request to bank=%u, row=%u\n", 
@@ -121,7 +238,7 @@ dram_req_t *frfcfs_scheduler::schedule( unsigned bank, unsigned curr_row ) // FR
 void frfcfs_scheduler::print( FILE *fp )
 {
    for ( unsigned b=0; b < m_config->nbk; b++ ) {
-      printf(" %u: queue length = %u\n", b, (unsigned)m_queue[b].size() );
+      printf(" %u: queue length = %u\n", b, m_banks[b].length );
    }
 }
 
@@ -158,6 +275,7 @@ void dram_t::scheduler_frfcfs()  // 行优先的先来先服务
             req->data->set_status(IN_PARTITION_MC_BANK_ARB_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle);
             prio = (prio+1)%m_config->nbk;
             bk[b]->mrq = req;
+            m_busy_banks++;
             if (m_config->gpgpu_memlatency_stat) {
                mrq_latency = gpu_sim_cycle + gpu_tot_sim_cycle - bk[b]->mrq->timestamp;
                bk[b]->mrq->timestamp = gpu_tot_sim_cycle + gpu_sim_cycle;
@@ -32,8 +32,7 @@
 #include "shader.h"
 #include "gpu-sim.h"
 #include "gpu-misc.h"
-#include <list>
-#include <map>
+#include <vector>
 
 class frfcfs_scheduler {
 public:
@@ -45,12 +44,43 @@ public:
    unsigned num_pending() const { return m_num_pending;}
 
 private:
+   static const unsigned NIL = (unsigned)-1;
+
+   // one pending request; linked into its bank's age list and its row's FIFO
+   struct sched_node {
+      dram_req_t *req;
+      unsigned older;     // age list, towards the oldest request in the bank
+      unsigned newer;     // age list, towards the newest request in the bank
+      unsigned row_next;  // next (younger) request to the same row
+   };
+   // row bin: FIFO of requests to one row, oldest at head
+   struct row_bin {
+      unsigned row;
+      unsigned head;      // NIL marks an empty table slot
+      unsigned tail;
+   };
+   struct bank_queue {
+      std::vector<row_bin> bins;  // open addressing, linear probing, power of two
+      unsigned num_bins;
+      unsigned newest;
+      unsigned oldest;
+      unsigned length;
+      bool row_open;              // a row is being drained (was m_last_row)
+      unsigned open_row;
+   };
+
+   unsigned find_bin( const bank_queue &b, unsigned row ) const;
+   unsigned insert_bin( bank_queue &b, unsigned row );
+   void erase_bin( bank_queue &b, unsigned slot );
+   void grow_bins( bank_queue &b );
+   unsigned alloc_node( dram_req_t *req );
+
    const memory_config *m_config;
    dram_t *m_dram;
    unsigned m_num_pending;
-   std::list<dram_req_t*>                                             *m_queue;
-   std::map<unsigned,std::list<std::list<dram_req_t*>::iterator> >    *m_bins;
-   std::list<std::list<dram_req_t*>::iterator>                        **m_last_row;
+   bank_queue *m_banks;
+   std::vector<sched_node> m_nodes; // node pool shared by all banks
+   unsigned m_free_node;
    unsigned *curr_row_service_time; // 每个bank对应一组变量                   /// one set of variables for each bank.
    unsigned *row_service_timestamp; // 用于跟踪，看调度程序何时为当前行提供服务   /// tracks when scheduler began servicing current row
 
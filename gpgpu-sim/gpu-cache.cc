@@ -28,6 +28,9 @@
 #include "gpu-cache.h"
 #include "stat-tool.h"
 #include <assert.h>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 #define MAX_DEFAULT_CACHE_SIZE_MULTIBLIER 4
 // used to allocate memory that is large enough to adapt the changes in cache size across kernels
@@ -114,6 +117,8 @@ unsigned l2_cache_config::set_index(new_addr_type addr) const{
 tag_array::~tag_array() 
 {
     delete[] m_lines;
+    delete[] m_tags;
+    delete[] m_repl_state;
 }
 
 tag_array::tag_array( cache_config &config,
@@ -143,6 +148,13 @@ tag_array::tag_array( cache_config &config, // cache配置
 
 void tag_array::init( int core_id, int type_id )    // 根据CORE的ID（本地） 和 cache的类型，初始化
 {
+    unsigned max_lines = MAX_DEFAULT_CACHE_SIZE_MULTIBLIER*m_config.get_num_lines();
+    m_tags = new new_addr_type[max_lines];
+    for (unsigned i=0; i < max_lines; i++) 
+        m_tags[i] = m_lines[i].m_tag;
+    m_repl_state = new unsigned long long[max_lines]; // a set has at least one line
+    for (unsigned i=0; i < max_lines; i++) 
+        m_repl_state[i] = 0;
     m_access = 0;
     m_miss = 0;
     m_pending_hit = 0;
@@ -155,6 +167,33 @@ void tag_array::init( int core_id, int type_id )    // 根据CORE的ID（本地
     m_type_id = type_id;
 }
 
+// bit w is set when tags[w] == tag, for up to 64 ways; all ways of a set are
+// compared at once where the target supports 64-bit vector compares
+static unsigned long long match_tags( const new_addr_type *tags, unsigned n, new_addr_type tag )
+{
+    unsigned long long match = 0;
+    unsigned w = 0;
+#if defined(__AVX2__)
+    const __m256i key4 = _mm256_set1_epi64x(tag);
+    for (; w+4 <= n; w+=4) {
+        __m256i t = _mm256_loadu_si256((const __m256i*)(tags+w));
+        unsigned m = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(t,key4)));
+        match |= (unsigned long long)m << w;
+    }
+#endif
+#if defined(__SSE4_1__)
+    const __m128i key2 = _mm_set1_epi64x(tag);
+    for (; w+2 <= n; w+=2) {
+        __m128i t = _mm_loadu_si128((const __m128i*)(tags+w));
+        unsigned m = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(t,key2)));
+        match |= (unsigned long long)m << w;
+    }
+#endif
+    for (; w < n; w++) 
+        match |= (unsigned long long)(tags[w] == tag) << w;
+    return match;
+}
+
 enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx ) const { // 探测函数。判断本次访问，是否命中。 返回：MISS 或 HIT
     //assert( m_config.m_write_policy == READ_ONLY );   // addr：block地址，  idx：cache的索引
     unsigned set_index = m_config.set_index(addr);  // 根据block地址，生成set_index
@@ -166,11 +205,16 @@ enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx )
 
     bool all_reserved = true;
 
-    // check for hit or pending hit
-    for (unsigned way=0; way<m_config.m_assoc; way++) {
-        unsigned index = set_index * m_config.m_assoc + way;    // 生成line索引
-        cache_block_t *line = &m_lines[index];                  // 取出line
-        if (line->m_tag == tag) {   // 对比tag是否相同      以下四个位对应cache的一致性：
+    // check for hit or pending hit: compare the tags of all ways at once, then
+    // check the state of the matching ways in order (a stale INVALID line may match)
+    const unsigned set_base = set_index * m_config.m_assoc;
+    for (unsigned base=0; base<m_config.m_assoc; base+=64) {
+        unsigned n = (m_config.m_assoc - base < 64)? m_config.m_assoc - base : 64;
+        unsigned long long match = match_tags(&m_tags[set_base+base], n, tag);
+        while (match) {   // 对比tag是否相同      以下四个位对应cache的一致性：
+            unsigned index = set_base + base + __builtin_ctzll(match);  // 生成line索引
+            match &= match - 1;
+            const cache_block_t *line = &m_lines[index];                // 取出line
             if ( line->m_status == RESERVED ) {             // 查看line的状态位 == 已预留   Reserved位有效表明该Cache Block中的数据是最新的，在主存储器中拥有该Cache Block的数据副本。在Eviction时不需要回写主存储器。其他CPU Core的Cache中不能含有该Cache Block的数据。这是由第一次对该数据进行写操作所达到的状态，读者可以简单回忆write-once的写回机制。
                 idx = index;            // cache索引 = index
                 return HIT_RESERVED;    // 返回探测状态：命中且保留
@@ -184,26 +228,49 @@ enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx )
                 assert( line->m_status == INVALID );        
             }
         }
-        if (line->m_status != RESERVED) {   // line的状态位： 不是预留状态。    此时这个line中的数据不是最新的，有可能需要更新
-            all_reserved = false;
-            if (line->m_status == INVALID) {    // 如果line的状态位 == 无效
-                invalid_line = index;       // 记录无效的索引
-            } else {    // line处于 有效 或者 修改 状态
-                // valid line : keep track of most appropriate replacement candidate
-                if ( m_config.m_replacement_policy == LRU ) {
-                    if ( line->m_last_access_time < valid_timestamp ) {
-                        valid_timestamp = line->m_last_access_time;
-                        valid_line = index;
-                    }
-                } else if ( m_config.m_replacement_policy == FIFO ) {
-                    if ( line->m_alloc_time < valid_timestamp ) {
-                        valid_timestamp = line->m_alloc_time;
-                        valid_line = index;
+    }
+
+    // miss: look for a replacement candidate
+    if ( m_config.m_replacement_policy == LRU || m_config.m_replacement_policy == FIFO ) {
+        for (unsigned way=0; way<m_config.m_assoc; way++) {
+            unsigned index = set_base + way;
+            const cache_block_t *line = &m_lines[index];
+            if (line->m_status != RESERVED) {   // line的状态位： 不是预留状态。    此时这个line中的数据不是最新的，有可能需要更新
+                all_reserved = false;
+                if (line->m_status == INVALID) {    // 如果line的状态位 == 无效
+                    invalid_line = index;       // 记录无效的索引
+                } else {    // line处于 有效 或者 修改 状态
+                    // valid line : keep track of most appropriate replacement candidate
+                    if ( m_config.m_replacement_policy == LRU ) {
+                        if ( line->m_last_access_time < valid_timestamp ) {
+                            valid_timestamp = line->m_last_access_time;
+                            valid_line = index;
+                        }
+                    } else if ( m_config.m_replacement_policy == FIFO ) {
+                        if ( line->m_alloc_time < valid_timestamp ) {
+                            valid_timestamp = line->m_alloc_time;
+                            valid_line = index;
+                        }
                     }
                 }
             }
         }
+    } else {
+        // the packed per-set state picks among the unreserved ways in constant time
+        unsigned long long unreserved = 0;
+        for (unsigned way=0; way<m_config.m_assoc; way++) {
+            enum cache_block_state status = m_lines[set_base + way].m_status;
+            if (status != RESERVED) {
+                unreserved |= 1ULL << way;
+                if (status == INVALID) 
+                    invalid_line = set_base + way;
+            }
+        }
+        all_reserved = (unreserved == 0);
+        if ( !all_reserved && invalid_line == (unsigned)-1 ) 
+            valid_line = set_base + repl_victim(set_index, unreserved);
     }
+
     if ( all_reserved ) {
         assert( m_config.m_alloc_policy == ON_MISS ); 
         return RESERVATION_FAIL; // miss and not enough space in cache to allocate on miss
@@ -237,6 +304,7 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
         m_pending_hit++;
     case HIT: 
         m_lines[idx].m_last_access_time=time; 
+        repl_touch(idx);
         break;
     case MISS:
         m_miss++;
@@ -246,7 +314,7 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
                 wb = true;
                 evicted = m_lines[idx];
             }
-            m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
+            allocate_line( idx, addr, time );
         }
         break;
     case RESERVATION_FAIL:
@@ -267,10 +335,188 @@ void tag_array::fill( new_addr_type addr, unsigned time )
     unsigned idx;
     enum cache_request_status status = probe(addr,idx);
     assert(status==MISS); // MSHR should have prevented redundant memory request
-    m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
+    allocate_line( idx, addr, time );
     m_lines[idx].fill(time);
 }
 
+/// Functional warming: apply an access to the tags and replacement state as
+/// if it had completed, without statistics, MSHRs or timing. Sets with an
+/// access in flight (reserved lines) are left alone.
+void tag_array::warm( new_addr_type addr, unsigned time, bool is_write )
+{
+    unsigned idx;
+    enum cache_request_status status = probe(addr,idx);
+    if ( status == MISS ) {
+        if ( is_write && m_config.m_write_alloc_policy == NO_WRITE_ALLOCATE ) 
+            return;
+        if ( m_config.m_alloc_policy == ON_MISS && m_lines[idx].m_status == RESERVED ) 
+            return;
+        allocate_line( idx, addr, time );
+        m_lines[idx].fill(time);
+    } else if ( status == HIT ) {
+        m_lines[idx].m_last_access_time = time;
+        repl_touch(idx);
+    } else {
+        return;
+    }
+    if ( is_write ) {
+        switch ( m_config.m_write_policy ) {
+        case WRITE_BACK: 
+        case WRITE_THROUGH: 
+            m_lines[idx].m_status = MODIFIED; 
+            break;
+        case WRITE_EVICT: 
+        case LOCAL_WB_GLOBAL_WT: // only global accesses are warmed
+            m_lines[idx].m_status = INVALID; 
+            break;
+        default: 
+            break;
+        }
+    }
+}
+
+/// End of functional warming: warmed lines carry timestamps from a private
+/// warming clock that is unrelated to the cycle count of the timing model.
+/// Replace them by their rank within the set, which keeps the LRU/FIFO order
+/// and makes them older than nearly everything the detailed run touches.
+void tag_array::rank_warm_times()
+{
+    const unsigned assoc = m_config.m_assoc;
+    std::vector<unsigned> last(assoc), alloc(assoc);
+    for (unsigned set_base=0; set_base < size(); set_base += assoc) {
+        cache_block_t *set = &m_lines[set_base];
+        for (unsigned w=0; w < assoc; w++) {
+            last[w] = alloc[w] = 0;
+            for (unsigned v=0; v < assoc; v++) {
+                if (set[v].m_last_access_time < set[w].m_last_access_time ||
+                    (set[v].m_last_access_time == set[w].m_last_access_time && v < w))
+                    last[w]++;
+                if (set[v].m_alloc_time < set[w].m_alloc_time ||
+                    (set[v].m_alloc_time == set[w].m_alloc_time && v < w))
+                    alloc[w]++;
+            }
+        }
+        for (unsigned w=0; w < assoc; w++) {
+            set[w].m_last_access_time = last[w];
+            set[w].m_alloc_time = alloc[w];
+            if (set[w].m_fill_time)
+                set[w].m_fill_time = alloc[w];
+        }
+    }
+}
+
+void tag_array::allocate_line( unsigned idx, new_addr_type addr, unsigned time )
+{
+    new_addr_type tag = m_config.tag(addr);
+    bool was_invalid = (m_lines[idx].m_status == INVALID);
+    m_lines[idx].allocate( tag, m_config.block_addr(addr), time );
+    m_tags[idx] = tag;
+    repl_insert(idx, was_invalid);
+}
+
+// SRRIP keeps a 2-bit re-reference prediction value (RRPV) per way, way w in
+// bits 2w+1:2w; 3 = re-reference expected in the distant future
+static const unsigned long long RRPV_LOW_BITS = 0x5555555555555555ULL;
+static const unsigned SRRIP_MAX_RRPV = 3;
+static const unsigned SRRIP_INSERT_RRPV = 2;
+
+// moves bit w of a 32-bit way mask to bit 2w
+static unsigned long long spread_way_mask( unsigned long long m )
+{
+    m &= 0xFFFFFFFFULL;
+    m = (m | (m << 16)) & 0x0000FFFF0000FFFFULL;
+    m = (m | (m << 8))  & 0x00FF00FF00FF00FFULL;
+    m = (m | (m << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+    m = (m | (m << 2))  & 0x3333333333333333ULL;
+    m = (m | (m << 1))  & RRPV_LOW_BITS;
+    return m;
+}
+
+void tag_array::repl_touch( unsigned idx )
+{
+    unsigned assoc = m_config.m_assoc;
+    unsigned way = idx % assoc;
+    unsigned long long &state = m_repl_state[idx / assoc];
+    switch ( m_config.m_replacement_policy ) {
+    case TREE_PLRU: 
+        // heap-ordered tree, node n in bit n; point every node on the path away from this way
+        for (unsigned n = way + assoc; n > 1; n >>= 1) {
+            if (n & 1) state &= ~(1ULL << (n >> 1));
+            else       state |= 1ULL << (n >> 1);
+        }
+        break;
+    case NRU: {
+        unsigned long long all = (assoc == 64)? ~0ULL : (1ULL << assoc) - 1;
+        state |= 1ULL << way;
+        if ( state == all ) 
+            state = 1ULL << way; // every way referenced: start a new epoch
+        break;
+    }
+    case SRRIP:
+        state &= ~(3ULL << (2*way)); // hit: predict near-immediate re-reference
+        break;
+    default: 
+        break;
+    }
+}
+
+void tag_array::repl_insert( unsigned idx, bool was_invalid )
+{
+    if ( m_config.m_replacement_policy != SRRIP ) {
+        repl_touch(idx);
+        return;
+    }
+    unsigned assoc = m_config.m_assoc;
+    unsigned way = idx % assoc;
+    unsigned long long &state = m_repl_state[idx / assoc];
+    unsigned long long lanes = spread_way_mask((assoc == 32)? 0xFFFFFFFFULL : (1ULL << assoc) - 1);
+    if ( !was_invalid ) {
+        // age the set as if the victim search had incremented every RRPV
+        // until the victim reached the distant value
+        unsigned rrpv = (state >> (2*way)) & 3;
+        for (unsigned i = rrpv; i < SRRIP_MAX_RRPV; i++) {
+            unsigned long long not_max = ~(state & (state >> 1)) & lanes;
+            state += not_max;
+        }
+    }
+    state = (state & ~(3ULL << (2*way))) | ((unsigned long long)SRRIP_INSERT_RRPV << (2*way));
+}
+
+unsigned tag_array::repl_victim( unsigned set_index, unsigned long long candidates ) const
+{
+    assert( candidates );
+    unsigned assoc = m_config.m_assoc;
+    unsigned long long state = m_repl_state[set_index];
+    unsigned fallback = __builtin_ctzll(candidates);
+    switch ( m_config.m_replacement_policy ) {
+    case TREE_PLRU: {
+        unsigned n = 1;
+        while ( n < assoc ) 
+            n = 2*n + ((state >> n) & 1);
+        unsigned way = n - assoc;
+        return ((candidates >> way) & 1)? way : fallback;
+    }
+    case NRU: {
+        unsigned long long unreferenced = candidates & ~state;
+        return unreferenced? __builtin_ctzll(unreferenced) : fallback;
+    }
+    case SRRIP: {
+        // the first way with the highest RRPV is the one aging would reach first
+        unsigned long long cand = spread_way_mask(candidates);
+        unsigned long long hi = (state >> 1) & RRPV_LOW_BITS;
+        unsigned long long lo = state & RRPV_LOW_BITS;
+        unsigned long long m;
+        if      ( (m = cand & hi & lo) )  return __builtin_ctzll(m) / 2;
+        else if ( (m = cand & hi & ~lo) ) return __builtin_ctzll(m) / 2;
+        else if ( (m = cand & ~hi & lo) ) return __builtin_ctzll(m) / 2;
+        return fallback;
+    }
+    default: 
+        abort();
+    }
+    return fallback;
+}
+
 void tag_array::fill( unsigned index, unsigned time ) 
 {
     assert( m_config.m_alloc_policy == ON_MISS );
@@ -349,64 +595,132 @@ bool was_read_sent( const std::list<cache_event> &events )      // 遍历事件l
 }
 /****************************************************************** MSHR ******************************************************************/
 
-/// Checks if there is a pending request to the lower memory level already
-bool mshr_table::probe( new_addr_type block_addr ) const{
-    table::const_iterator a = m_data.find(block_addr);
-    return a != m_data.end();
+mshr_table::mshr_table( unsigned num_entries, unsigned max_merged )
+: m_num_entries(num_entries),
+m_max_merged(max_merged),
+m_entries(num_entries),
+m_merged(num_entries*max_merged)
+{
+    assert( num_entries > 0 && max_merged > 0 );
+    unsigned index_size = 2;
+    m_index_shift = 31;
+    while ( index_size < 2*num_entries ) {
+        index_size <<= 1;
+        m_index_shift--;
+    }
+    m_index.resize(index_size,0);
+    m_index_mask = index_size-1;
+    for ( int e=num_entries-1; e >= 0; e-- )
+        m_free.push_back(e);
+    m_ready_head = -1;
+    m_ready_tail = -1;
+    m_num_ready = 0;
 }
 
 /// Checks if there is space for tracking a new memory access
 bool mshr_table::full( new_addr_type block_addr ) const{
-    table::const_iterator i=m_data.find(block_addr);
-    if ( i != m_data.end() )
-        return i->second.m_list.size() >= m_max_merged;
+    unsigned i = m_index[find_slot(block_addr)];
+    if ( i )
+        return m_entries[i-1].m_count >= m_max_merged;
     else
-        return m_data.size() >= m_num_entries;
+        return m_free.empty();
 }
 
 /// Add or merge this access
 void mshr_table::add( new_addr_type block_addr, mem_fetch *mf ){
-	m_data[block_addr].m_list.push_back(mf);
-	assert( m_data.size() <= m_num_entries );
-	assert( m_data[block_addr].m_list.size() <= m_max_merged );
+    unsigned h = find_slot(block_addr);
+    if ( m_index[h] == 0 ) {
+        assert( !m_free.empty() );
+        int e = m_free.back();
+        m_free.pop_back();
+        mshr_entry &n = m_entries[e];
+        n.m_block_addr = block_addr;
+        n.m_head = 0;
+        n.m_count = 0;
+        n.m_next_ready = -1;
+        n.m_ready = false;
+        n.m_has_atomic = false;
+        m_index[h] = e+1;
+    }
+    int e = m_index[h]-1;
+    mshr_entry &entry = m_entries[e];
+    assert( entry.m_count < m_max_merged );
+    unsigned slot = entry.m_head + entry.m_count++;
+    if ( slot >= m_max_merged )
+        slot -= m_max_merged;
+    m_merged[e*m_max_merged+slot] = mf;
 	// indicate that this MSHR entry contains an atomic operation
 	if ( mf->isatomic() ) {
-		m_data[block_addr].m_has_atomic = true;
+		entry.m_has_atomic = true;
 	}
 }
 
 /// Accept a new cache fill response: mark entry ready for processing
 void mshr_table::mark_ready( new_addr_type block_addr, bool &has_atomic ){
     assert( !busy() );
-    table::iterator a = m_data.find(block_addr);
-    assert( a != m_data.end() ); // don't remove same request twice
-    m_current_response.push_back( block_addr );
-    has_atomic = a->second.m_has_atomic;
-    assert( m_current_response.size() <= m_data.size() );
+    unsigned i = m_index[find_slot(block_addr)];
+    assert( i != 0 ); 
+    int e = i-1;
+    assert( !m_entries[e].m_ready ); // don't remove same request twice
+    m_entries[e].m_ready = true;
+    if ( m_ready_tail >= 0 )
+        m_entries[m_ready_tail].m_next_ready = e;
+    else
+        m_ready_head = e;
+    m_ready_tail = e;
+    m_num_ready++;
+    has_atomic = m_entries[e].m_has_atomic;
+    assert( m_num_ready <= m_num_entries - m_free.size() );
 }
 
 /// Returns next ready access
 mem_fetch *mshr_table::next_access(){
     assert( access_ready() );
-    new_addr_type block_addr = m_current_response.front();
-    assert( !m_data[block_addr].m_list.empty() );
-    mem_fetch *result = m_data[block_addr].m_list.front();
-    m_data[block_addr].m_list.pop_front();
-    if ( m_data[block_addr].m_list.empty() ) {
+    int e = m_ready_head;
+    mshr_entry &entry = m_entries[e];
+    assert( entry.m_count > 0 );
+    mem_fetch *result = m_merged[e*m_max_merged+entry.m_head];
+    if ( ++entry.m_head == m_max_merged )
+        entry.m_head = 0;
+    if ( --entry.m_count == 0 ) {
         // release entry
-        m_data.erase(block_addr);
-        m_current_response.pop_front();
+        m_ready_head = entry.m_next_ready;
+        if ( m_ready_head < 0 )
+            m_ready_tail = -1;
+        m_num_ready--;
+        release(e);
     }
     return result;
 }
 
+/// Removes entry e from the index, shifting later probes back into the hole
+void mshr_table::release( int e ){
+    unsigned hole = find_slot(m_entries[e].m_block_addr);
+    assert( m_index[hole] == (unsigned)e+1 );
+    m_index[hole] = 0;
+    for ( unsigned h=(hole+1)&m_index_mask; m_index[h]; h=(h+1)&m_index_mask ) {
+        unsigned home = hash(m_entries[m_index[h]-1].m_block_addr);
+        // move the entry unless its home slot lies cyclically in (hole,h]
+        if ( ((h-home)&m_index_mask) >= ((h-hole)&m_index_mask) ) {
+            m_index[hole] = m_index[h];
+            m_index[h] = 0;
+            hole = h;
+        }
+    }
+    m_free.push_back(e);
+}
+
 void mshr_table::display( FILE *fp ) const{
     fprintf(fp,"MSHR contents\n");
-    for ( table::const_iterator e=m_data.begin(); e!=m_data.end(); ++e ) {
-        unsigned block_addr = e->first;
-        fprintf(fp,"MSHR: tag=0x%06x, atomic=%d %zu entries : ", block_addr, e->second.m_has_atomic, e->second.m_list.size());
-        if ( !e->second.m_list.empty() ) {
-            mem_fetch *mf = e->second.m_list.front();
+    for ( unsigned h=0; h < m_index.size(); h++ ) {
+        if ( !m_index[h] )
+            continue;
+        int e = m_index[h]-1;
+        const mshr_entry &entry = m_entries[e];
+        unsigned block_addr = entry.m_block_addr;
+        fprintf(fp,"MSHR: tag=0x%06x, atomic=%d %u entries : ", block_addr, entry.m_has_atomic, entry.m_count);
+        if ( entry.m_count ) {
+            mem_fetch *mf = m_merged[e*m_max_merged+entry.m_head];
             fprintf(fp,"%p :",mf);
             mf->print(fp);
         } else {
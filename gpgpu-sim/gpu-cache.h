@@ -96,7 +96,10 @@ struct cache_block_t {
 
 enum replacement_policy_t {
     LRU,
-    FIFO
+    FIFO,
+    TREE_PLRU,
+    NRU,
+    SRRIP
 };
 
 enum write_policy_t {
@@ -164,6 +167,9 @@ public:
         switch (rp) {
         case 'L': m_replacement_policy = LRU; break;
         case 'F': m_replacement_policy = FIFO; break;
+        case 'P': m_replacement_policy = TREE_PLRU; break;
+        case 'N': m_replacement_policy = NRU; break;
+        case 'S': m_replacement_policy = SRRIP; break;
         default: exit_parse_error();
         }
         switch (wp) {
@@ -188,6 +194,15 @@ public:
         m_nset_log2 = LOGB2(m_nset);
         m_valid = true;
 
+        // these policies keep their state for a set in one 64-bit word
+        if ( (m_replacement_policy == TREE_PLRU && (m_assoc > 64 || (m_assoc & (m_assoc-1)))) ||
+             (m_replacement_policy == NRU && m_assoc > 64) ||
+             (m_replacement_policy == SRRIP && m_assoc > 32) ) {
+            printf("GPGPU-Sim uArch: replacement policy %c does not support associativity %u "
+                   "(P: power of two up to 64, N: up to 64, S: up to 32)\n", rp, m_assoc );
+            exit_parse_error();
+        }
+
         switch(wap){
         case 'W': m_write_alloc_policy = WRITE_ALLOCATE; break;
         case 'N': m_write_alloc_policy = NO_WRITE_ALLOCATE; break;
@@ -286,7 +301,7 @@ protected:
     unsigned m_nset_log2;
     unsigned m_assoc;           //
 
-    enum replacement_policy_t m_replacement_policy; // 'L' = LRU, 'F' = FIFO
+    enum replacement_policy_t m_replacement_policy; // 'L' = LRU, 'F' = FIFO, 'P' = tree pseudo-LRU, 'N' = NRU, 'S' = SRRIP
     enum write_policy_t m_write_policy;             // 'T' = write through, 'B' = write back, 'R' = read only
     enum allocation_policy_t m_alloc_policy;        // 'm' = allocate on miss, 'f' = allocate on fill
     enum mshr_config_t m_mshr_type;
@@ -346,6 +361,8 @@ public:
 
     void fill( new_addr_type addr, unsigned time );
     void fill( unsigned idx, unsigned time );
+    void warm( new_addr_type addr, unsigned time, bool is_write );
+    void rank_warm_times();
 
     unsigned size() const { return m_config.get_num_lines();}
     cache_block_t &get_block(unsigned idx) { return m_lines[idx];}
@@ -367,12 +384,20 @@ protected:
                int type_id,
                cache_block_t* new_lines );
     void init( int core_id, int type_id );
+    void allocate_line( unsigned idx, new_addr_type addr, unsigned time );
+
+    // TREE_PLRU, NRU and SRRIP state updates and victim choice
+    void repl_touch( unsigned idx );
+    void repl_insert( unsigned idx, bool was_invalid );
+    unsigned repl_victim( unsigned set_index, unsigned long long candidates ) const;
 
 protected:
 
     cache_config &m_config;
 
     cache_block_t *m_lines; /* nbanks x nset x assoc lines in total */
+    new_addr_type *m_tags;  /* copy of m_lines[].m_tag, contiguous per set for the hit compare */
+    unsigned long long *m_repl_state; /* one word per set: PLRU tree bits, NRU referenced bits or 2-bit SRRIP values */
 
     unsigned m_access;
     unsigned m_miss;
@@ -390,17 +415,10 @@ protected:
 
 class mshr_table {
 public:
-    mshr_table( unsigned num_entries, unsigned max_merged )
-    : m_num_entries(num_entries),
-    m_max_merged(max_merged)
-#if (tr1_hash_map_ismap == 0)
-    ,m_data(2*num_entries)
-#endif
-    {
-    }
+    mshr_table( unsigned num_entries, unsigned max_merged );
 
     /// Checks if there is a pending request to the lower memory level already
-    bool probe( new_addr_type block_addr ) const;
+    bool probe( new_addr_type block_addr ) const { return m_index[find_slot(block_addr)] != 0; }
     /// Checks if there is space for tracking a new memory access
     bool full( new_addr_type block_addr ) const;
     /// Add or merge this access
@@ -410,7 +428,7 @@ public:
     /// Accept a new cache fill response: mark entry ready for processing
     void mark_ready( new_addr_type block_addr, bool &has_atomic );
     /// Returns true if ready accesses exist
-    bool access_ready() const {return !m_current_response.empty();}
+    bool access_ready() const {return m_ready_head >= 0;}
     /// Returns next ready access
     mem_fetch *next_access();
     void display( FILE *fp ) const;
@@ -422,22 +440,44 @@ public:
     }
 
 private:
+    /// Index slot holding block_addr, or the empty slot where it would go
+    unsigned find_slot( new_addr_type block_addr ) const
+    {
+        unsigned h = hash(block_addr);
+        while ( m_index[h] && m_entries[m_index[h]-1].m_block_addr != block_addr )
+            h = (h+1) & m_index_mask;
+        return h;
+    }
+    // keep the high bits of the product: block addresses are line aligned,
+    // so the low bits of block_addr*2654435761u are always zero
+    unsigned hash( new_addr_type block_addr ) const { return ((unsigned)block_addr*2654435761u) >> m_index_shift; }
+    void release( int e );
 
     // finite sized, fully associative table, with a finite maximum number of merged requests
     const unsigned m_num_entries;
     const unsigned m_max_merged;
 
     struct mshr_entry {
-        std::list<mem_fetch*> m_list;
+        new_addr_type m_block_addr;
+        unsigned m_head;    // oldest merged request, as a slot in this entry's part of m_merged
+        unsigned m_count;   // number of merged requests
+        int m_next_ready;   // next entry in the ready queue
+        bool m_ready;
         bool m_has_atomic; 
-        mshr_entry() : m_has_atomic(false) { }
     }; 
-    typedef tr1_hash_map<new_addr_type,mshr_entry> table;
-    table m_data;
-
-    // it may take several cycles to process the merged requests
-    bool m_current_response_ready;
-    std::list<new_addr_type> m_current_response;
+    // entries and their merged requests are preallocated; m_index maps a
+    // block address to 1 + its entry by linear probing (0 = empty slot)
+    std::vector<mshr_entry> m_entries;
+    std::vector<mem_fetch*> m_merged; // m_max_merged slots per entry, used as a ring
+    std::vector<int> m_free;          // unused entries
+    std::vector<unsigned> m_index;
+    unsigned m_index_mask;
+    unsigned m_index_shift; // 32 - log2(m_index.size())
+
+    // ready entries in fill order; it may take several cycles to process the merged requests
+    int m_ready_head;
+    int m_ready_tail;
+    unsigned m_num_ready;
 };
 
 
@@ -594,6 +634,9 @@ public:
     mem_fetch *next_access(){return m_mshrs.next_access();}     // 弹出下一个准备好的访问（mf），注：不包括”HIT“访问
     // flash invalidate all entries in cache
     void flush(){m_tag_array->flush();}
+    // functional warming: update tags and replacement state only
+    void warm( new_addr_type addr, bool is_write, unsigned time ){ m_tag_array->warm(m_config.block_addr(addr),time,is_write); }
+    void finish_warming(){ m_tag_array->rank_warm_times(); }
     void print(FILE *fp, unsigned &accesses, unsigned &misses) const;
     void display_state( FILE *fp ) const;
 
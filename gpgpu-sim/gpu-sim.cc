@@ -51,6 +51,7 @@
 #include "l2cache.h"
 
 #include "../cuda-sim/ptx-stats.h"
+#include "../cuda-sim/cuda_device_printf.h"
 #include "../statwrapper.h"
 #include "../abstract_hardware_model.h"
 #include "../debug.h"
@@ -141,6 +142,10 @@ void memory_config::reg_options(class OptionParser * opp)
 {
     option_parser_register(opp, "-gpgpu_dram_scheduler", OPT_INT32, &scheduler_type, 
                                 "0 = fifo, 1 = FR-FCFS (defaul)", "1");
+    option_parser_register(opp, "-gpgpu_dram_model", OPT_INT32, &dram_model, 
+                                "0 = GDDR command model (default), 1 = HBM2 pseudo-channels, 2 = fixed latency/bandwidth", "0");
+    option_parser_register(opp, "-gpgpu_dram_fixed_latency", OPT_UINT32, &dram_fixed_latency, 
+                                "access latency in DRAM cycles for -gpgpu_dram_model 2 (default 40)", "40");
     option_parser_register(opp, "-gpgpu_dram_partition_queues", OPT_CSTR, &gpgpu_L2_queue_config, 
                            "i2$:$2d:d2$:$2i",
                            "8:8:8:8");
@@ -149,7 +154,7 @@ void memory_config::reg_options(class OptionParser * opp)
                            "Use a ideal L2 cache that always hit",
                            "0");
     option_parser_register(opp, "-gpgpu_cache:dl2", OPT_CSTR, &m_L2_config.m_config_string, 
-                   "unified banked L2 data cache config "
+                   "unified banked L2 data cache config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>}",
                    "64:128:8,L:B:m:N,A:16:4,4");
     option_parser_register(opp, "-gpgpu_cache:dl2_texture_only", OPT_BOOL, &m_L2_texure_only, 
@@ -203,27 +208,27 @@ void shader_core_config::reg_options(class OptionParser * opp)
                    "shader core pipeline config, i.e., {<nthread>:<warpsize>}",
                    "1024:32");
     option_parser_register(opp, "-gpgpu_tex_cache:l1", OPT_CSTR, &m_L1T_config.m_config_string, 
-                   "per-shader L1 texture cache  (READ-ONLY) config "
+                   "per-shader L1 texture cache  (READ-ONLY) config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>:<rf>}",
                    "8:128:5,L:R:m:N,F:128:4,128:2");
     option_parser_register(opp, "-gpgpu_const_cache:l1", OPT_CSTR, &m_L1C_config.m_config_string, 
-                   "per-shader L1 constant memory cache  (READ-ONLY) config "
+                   "per-shader L1 constant memory cache  (READ-ONLY) config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>} ",
                    "64:64:2,L:R:f:N,A:2:32,4" );
     option_parser_register(opp, "-gpgpu_cache:il1", OPT_CSTR, &m_L1I_config.m_config_string, 
-                   "shader L1 instruction cache config "
+                   "shader L1 instruction cache config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>} ",
                    "4:256:4,L:R:f:N,A:2:32,4" );
     option_parser_register(opp, "-gpgpu_cache:dl1", OPT_CSTR, &m_L1D_config.m_config_string,
-                   "per-shader L1 data cache config "
+                   "per-shader L1 data cache config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
                    "none" );
     option_parser_register(opp, "-gpgpu_cache:dl1PrefL1", OPT_CSTR, &m_L1D_config.m_config_stringPrefL1,
-                   "per-shader L1 data cache config "
+                   "per-shader L1 data cache config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
                    "none" );
     option_parser_register(opp, "-gpgpu_cache:dl1PreShared", OPT_CSTR, &m_L1D_config.m_config_stringPrefShared,
-                   "per-shader L1 data cache config "
+                   "per-shader L1 data cache config (<rep> = L:LRU, F:FIFO, P:tree-PLRU, N:NRU, S:SRRIP)"
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
                    "none" );
     option_parser_register(opp, "-gmem_skip_L1D", OPT_BOOL, &gmem_skip_L1D, 
@@ -399,6 +404,15 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
    option_parser_register(opp, "-gpgpu_deadlock_detect", OPT_BOOL, &gpu_deadlock_detect, 
                 "Stop the simulation at deadlock (1=on (default), 0=off)", 
                 "1");
+   option_parser_register(opp, "-gpgpu_fast_forward_kernels", OPT_UINT32, &gpgpu_fast_forward_kernels, 
+                "Simulate the first N kernel launches functionally, then switch to performance simulation (default = 0)", 
+                "0");
+   option_parser_register(opp, "-gpgpu_functional_cache_warming", OPT_BOOL, &gpgpu_functional_cache_warming, 
+                "Replay global loads/stores of fast-forwarded kernels (-gpgpu_fast_forward_kernels) into the L1D/L2 tags (1=on, 0=off (default))", 
+                "0");
+   option_parser_register(opp, "-gpgpu_mem_fetch_pool_debug", OPT_BOOL, &gpgpu_mem_fetch_pool_debug, 
+                "Track live mem_fetch objects to report leaks and double frees (1=on, 0=off (default))", 
+                "0");
    option_parser_register(opp, "-gpgpu_ptx_instruction_classification", OPT_INT32, 
                &gpgpu_ptx_instruction_classification, 
                "if enabled will classify ptx instruction types per kernel (Max 255 kernels now)", 
@@ -465,6 +479,7 @@ void gpgpu_sim::launch( kernel_info_t *kinfo )  // 启动传入的kernel
              m_shader_config->n_thread_per_shader );
       printf("                 => either change -gpgpu_shader argument in gpgpusim.config file or\n");
       printf("                 modify the CUDA source to decrease the kernel block size.\n");
+      gpgpusim_cuda_printf_flush_all();
       abort();
    }
    unsigned n=0;  // 遍历运行kernel向量，找出一个空位置 || 存在已经运行完成的kernel
@@ -530,6 +545,7 @@ unsigned gpgpu_sim::finished_kernel()
 void gpgpu_sim::set_kernel_done( kernel_info_t *kernel ) 
 { 
     unsigned uid = kernel->get_uid();
+    gpgpusim_cuda_printf_flush(uid);
     m_finished_kernel.push_back(uid);
     std::vector<kernel_info_t*>::iterator k;
     for( k=m_running_kernels.begin(); k!=m_running_kernels.end(); k++ ) {
@@ -549,6 +565,7 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )   // gpgpu模拟器构造
     m_shader_config = &m_config.m_shader_config;   // shader配置  shader 与 CORE区别：主要是在查找上，shader的id是全局的，而CORE需要先找cluster的id再找CORE
     m_memory_config = &m_config.m_memory_config;   // 主存配置
     set_ptx_warp_size(m_shader_config);
+    mem_fetch::pool_set_debug(m_config.gpgpu_mem_fetch_pool_debug);
     ptx_file_line_stats_create_exposed_latency_tracker(m_config.num_shader());
 
 #ifdef GPGPUSIM_POWER_MODEL
@@ -589,7 +606,10 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )   // gpgpu模拟器构造
 
     m_running_kernels.resize( config.max_concurrent_kernel, NULL );  // 规定gpgpu模拟器所能同时运行的kernel数，初始化运行kernel向量
     m_last_issued_kernel = 0;
-    m_last_cluster_issue = 0;    // 记录指令发射的最后一个集群的id
+    m_last_cluster_issue = 0;
+    m_fast_forwarded_kernels = 0;
+    m_fast_forwarding = false;
+    m_warm_time = 0;    // 记录指令发射的最后一个集群的id
     *average_pipeline_duty_cycle=0;
     *active_sms=0;
 
@@ -717,6 +737,10 @@ void gpgpu_sim::init()
 }
 
 void gpgpu_sim::update_stats() {
+    // the GPU has stopped; kernels cut off by -gpgpu_max_cycle/insn/cta never 
+    // reach set_kernel_done(), so emit their device printf output here
+    gpgpusim_cuda_printf_flush_all();
+    m_memory_config->m_address_mapping.flush_record();
     m_memory_stats->memlatstat_lat_pw();
     gpu_tot_sim_cycle += gpu_sim_cycle;
     gpu_tot_sim_insn += gpu_sim_insn;
@@ -727,6 +751,12 @@ void gpgpu_sim::print_stats()
     ptx_file_line_stats_write_file();
     gpu_print_stat();
 
+    // once the memory system has drained no request should still be allocated
+    if (m_config.gpgpu_mem_fetch_pool_debug && mem_fetch::pool_live() > 0 && !active()) {
+        printf("GPGPU-Sim uArch: WARNING ** mem_fetch leak detected\n");
+        mem_fetch::pool_print_live(stdout);
+    }
+
     if (g_network_mode) {
         printf("----------------------------Interconnect-DETAILS--------------------------------\n" );
         icnt_display_stats();
@@ -735,6 +765,63 @@ void gpgpu_sim::print_stats()
     }
 }
 
+// Called for every kernel launch that would go to the timing model. Returns
+// true while the launch is still inside the fast-forward window; the caller
+// then simulates it functionally and calls end_fast_forward() afterwards.
+bool gpgpu_sim::begin_fast_forward()
+{
+    if (m_fast_forwarded_kernels >= m_config.gpgpu_fast_forward_kernels) 
+        return false;
+    m_fast_forwarded_kernels++;
+    m_fast_forwarding = true;
+    return true;
+}
+
+void gpgpu_sim::end_fast_forward()
+{
+    assert(m_fast_forwarding);
+    m_fast_forwarding = false;
+    if (m_fast_forwarded_kernels == m_config.gpgpu_fast_forward_kernels) {
+        printf("GPGPU-Sim uArch: fast forward done after %u kernels, switching to performance simulation\n", 
+               m_fast_forwarded_kernels);
+        if (m_config.gpgpu_functional_cache_warming) {
+            for (unsigned i=0; i < m_shader_config->n_simt_clusters; i++) 
+                m_cluster[i]->finish_warming_L1D();
+            for (unsigned i=0; i < m_memory_config->m_n_mem_sub_partition; i++) 
+                m_memory_sub_partition[i]->finish_warmingL2();
+        }
+    }
+}
+
+// Functional cache warming: a fast-forwarded warp instruction updates the
+// L1D of the core its CTA is assigned to (round robin by CTA id, like the
+// CTA issue order) and the L2 bank owning each line. Every access the
+// coalescer would generate is applied in turn. Only tag and replacement
+// state change; timing, MSHRs and the interconnect are not involved.
+void gpgpu_sim::functional_cache_warm( const warp_inst_t &inst, unsigned cta_id )
+{
+    if (!m_fast_forwarding || !m_config.gpgpu_functional_cache_warming) 
+        return;
+    if (inst.space.get_type() != global_space || inst.empty() || 
+        (inst.memory_op != memory_load && inst.memory_op != memory_store)) 
+        return;
+    unsigned sid = cta_id % m_shader_config->num_shader();
+    simt_core_cluster *cluster = m_cluster[m_shader_config->sid_to_cluster(sid)];
+    warp_inst_t accesses = inst;
+    accesses.generate_mem_accesses();
+    while (!accesses.accessq_empty()) {
+        const mem_access_t &access = accesses.accessq_back();
+        new_addr_type addr = access.get_addr();
+        bool is_write = access.is_write();
+        unsigned time = m_warm_time++;
+        cluster->warm_L1D(sid, addr, is_write, time);
+        addrdec_t tlx;
+        m_memory_config->m_address_mapping.addrdec_tlx(addr,&tlx);
+        m_memory_sub_partition[tlx.sub_partition]->warmL2(addr, is_write, time);
+        accesses.accessq_pop_back();
+    }
+}
+
 void gpgpu_sim::deadlock_check()
 {
    if (m_config.gpu_deadlock_detect && gpu_deadlock) {
@@ -771,6 +858,8 @@ void gpgpu_sim::deadlock_check()
       }
       printf("\nRe-run the simulator in gdb and use debug routines in .gdbinit to debug this\n");
       fflush(stdout);
+      m_memory_config->m_address_mapping.flush_record();
+      gpgpusim_cuda_printf_flush_all();
       abort();
    }
 }
@@ -899,6 +988,7 @@ void gpgpu_sim::gpu_print_stat()
    // performance counter for stalls due to congestion.
    printf("gpu_stall_dramfull = %d\n", gpu_stall_dramfull);
    printf("gpu_stall_icnt2sh    = %d\n", gpu_stall_icnt2sh );
+   printf("gpu_mem_fetch_live_max = %u\n", mem_fetch::pool_live_max() );
 
    time_t curr_time;
    time(&curr_time);
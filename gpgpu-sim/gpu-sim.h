@@ -66,6 +66,13 @@ enum dram_ctrl_t
     DRAM_FRFCFS = 1
 };
 
+enum dram_model_t
+{
+    DRAM_MODEL_GDDR = 0,    // command accurate model (dram_t)
+    DRAM_MODEL_HBM2 = 1,    // two pseudo-channels per channel
+    DRAM_MODEL_FIXED = 2    // fixed latency, bandwidth limited
+};
+
 struct power_config
 {
     power_config()
@@ -195,6 +202,9 @@ struct memory_config
         }
         bk_tag_length = i;
         assert(nbkgrp > 0 && "Number of bank groups cannot be zero");
+        if (dram_model == DRAM_MODEL_HBM2) {
+            assert(nbk % 2 == 0 && busW % 2 == 0 && "HBM2 pseudo-channels need an even number of banks and bus width");
+        }
         tRCDWR = tRCD - (WL + 1);
         tRTW = (CL + (BL / data_command_freq_ratio) + 2 - WL);
         tWTR = (WL + (BL / data_command_freq_ratio) + tCDLR);
@@ -224,6 +234,8 @@ struct memory_config
     unsigned gpgpu_frfcfs_dram_sched_queue_size;
     unsigned gpgpu_dram_return_queue_size;
     enum dram_ctrl_t scheduler_type;
+    enum dram_model_t dram_model;
+    unsigned dram_fixed_latency;
     bool gpgpu_memlatency_stat;
     unsigned m_n_mem;
     unsigned m_n_sub_partition_per_memory_channel;
@@ -341,6 +353,9 @@ private:
     bool gpgpu_flush_l2_cache; // L2 cache 是否刷新
 
     bool gpu_deadlock_detect; // 检测gpu中是否存在死锁
+    bool gpgpu_mem_fetch_pool_debug;
+    unsigned gpgpu_fast_forward_kernels;
+    bool gpgpu_functional_cache_warming;
 
     int gpgpu_frfcfs_dram_sched_queue_size; //
     int gpgpu_cflog_interval;
@@ -379,6 +394,10 @@ public:
     void print_stats();    // 输出gpgpu模拟器的统计信息
     void update_stats();   // 更新统计信息
     void deadlock_check(); // 检查是否有死锁
+    // fast forward: the first -gpgpu_fast_forward_kernels launches run functionally
+    bool begin_fast_forward();
+    void end_fast_forward();
+    void functional_cache_warm( const class warp_inst_t &inst, unsigned cta_id );
 
     void get_pdom_stack_top_info(unsigned sid, unsigned tid, unsigned *pc, unsigned *rpc);
 
@@ -442,6 +461,9 @@ private:
     unsigned m_last_issued_kernel;                  // 最后一个发射的kernel的uid(id)
 
     std::list<unsigned> m_finished_kernel;
+    unsigned m_fast_forwarded_kernels;
+    bool m_fast_forwarding;
+    unsigned m_warm_time; // warming clock, advances on every warmed access
     unsigned m_total_cta_launched;
     unsigned m_last_cluster_issue;
     float *average_pipeline_duty_cycle;
@@ -29,6 +29,7 @@
 #include <assert.h>
 #include "../intersim2/globals.hpp"
 #include "../intersim2/interconnect_interface.hpp"
+#include "local_interconnect.h"
 
 icnt_create_p                icnt_create;
 icnt_init_p                  icnt_init;
@@ -37,6 +38,7 @@ icnt_push_p                  icnt_push;
 icnt_pop_p                   icnt_pop;
 icnt_transfer_p              icnt_transfer;
 icnt_busy_p                  icnt_busy;
+icnt_idle_p                  icnt_idle;
 icnt_display_stats_p         icnt_display_stats;
 icnt_display_overall_stats_p icnt_display_overall_stats;
 icnt_display_state_p         icnt_display_state;
@@ -85,6 +87,11 @@ static bool intersim2_busy()
    return g_icnt_interface->Busy();
 }
 
+static bool intersim2_idle()
+{
+   return g_icnt_interface->Idle();
+}
+
 static void intersim2_display_stats()
 {
    g_icnt_interface->DisplayStats();
@@ -105,10 +112,85 @@ static unsigned intersim2_get_flit_size()
    return g_icnt_interface->GetFlitSize();
 }
 
+// Wrapper to the analytical crossbar (local_interconnect.h)
+
+static local_crossbar *g_local_xbar;
+
+static void local_xbar_create(unsigned int n_shader, unsigned int n_mem)
+{
+   g_local_xbar->create(n_shader, n_mem);
+}
+
+static void local_xbar_init()
+{
+   g_local_xbar->init();
+}
+
+static bool local_xbar_has_buffer(unsigned input, unsigned int size)
+{
+   return g_local_xbar->has_buffer(input, size);
+}
+
+static void local_xbar_push(unsigned input, unsigned output, void* data, unsigned int size)
+{
+   g_local_xbar->push(input, output, data, size);
+}
+
+static void* local_xbar_pop(unsigned output)
+{
+   return g_local_xbar->pop(output);
+}
+
+static void local_xbar_transfer()
+{
+   g_local_xbar->advance();
+}
+
+static bool local_xbar_busy()
+{
+   return g_local_xbar->busy();
+}
+
+static bool local_xbar_idle()
+{
+   return !g_local_xbar->busy();
+}
+
+static void local_xbar_display_stats()
+{
+   g_local_xbar->display_stats();
+}
+
+static void local_xbar_display_overall_stats()
+{
+   g_local_xbar->display_overall_stats();
+}
+
+static void local_xbar_display_state(FILE *fp)
+{
+   g_local_xbar->display_state(fp);
+}
+
+static unsigned local_xbar_get_flit_size()
+{
+   return g_local_xbar->get_flit_size();
+}
+
 void icnt_reg_options( class OptionParser * opp )
 {
-   option_parser_register(opp, "-network_mode", OPT_INT32, &g_network_mode, "Interconnection network mode", "1");
+   option_parser_register(opp, "-network_mode", OPT_INT32, &g_network_mode, "Interconnection network mode (1 = intersim2, 2 = analytical crossbar)", "1");
    option_parser_register(opp, "-inter_config_file", OPT_CSTR, &g_network_config_filename, "Interconnection network config file", "mesh");
+
+   option_parser_register(opp, "-icnt_xbar_latency", OPT_UINT32, &g_local_xbar_config.latency, 
+                          "crossbar (network_mode 2): cycles from the last flit crossing to delivery", "5");
+   option_parser_register(opp, "-icnt_xbar_bandwidth", OPT_UINT32, &g_local_xbar_config.bandwidth, 
+                          "crossbar (network_mode 2): flits per cycle per port", "1");
+   option_parser_register(opp, "-icnt_xbar_in_buffer", OPT_UINT32, &g_local_xbar_config.in_buffer, 
+                          "crossbar (network_mode 2): input buffer depth in flits", "64");
+   option_parser_register(opp, "-icnt_xbar_out_buffer", OPT_UINT32, &g_local_xbar_config.out_buffer, 
+                          "crossbar (network_mode 2): packets in flight to or waiting at an output", "16");
+   option_parser_register(opp, "-icnt_xbar_flit_size", OPT_UINT32, &g_local_xbar_config.flit_size, 
+                          "crossbar (network_mode 2): flit size in bytes", "32");
 }
 
 void icnt_wrapper_init()
@@ -124,11 +206,27 @@ void icnt_wrapper_init()
          icnt_pop        = intersim2_pop;
          icnt_transfer   = intersim2_transfer;
          icnt_busy       = intersim2_busy;
+         icnt_idle       = intersim2_idle;
          icnt_display_stats = intersim2_display_stats;
          icnt_display_overall_stats = intersim2_display_overall_stats;
          icnt_display_state = intersim2_display_state;
          icnt_get_flit_size = intersim2_get_flit_size;
          break;
+      case LOCAL_XBAR:
+         g_local_xbar = new local_crossbar(g_local_xbar_config);
+         icnt_create     = local_xbar_create;
+         icnt_init       = local_xbar_init;
+         icnt_has_buffer = local_xbar_has_buffer;
+         icnt_push       = local_xbar_push;
+         icnt_pop        = local_xbar_pop;
+         icnt_transfer   = local_xbar_transfer;
+         icnt_busy       = local_xbar_busy;
+         icnt_idle       = local_xbar_idle;
+         icnt_display_stats = local_xbar_display_stats;
+         icnt_display_overall_stats = local_xbar_display_overall_stats;
+         icnt_display_state = local_xbar_display_state;
+         icnt_get_flit_size = local_xbar_get_flit_size;
+         break;
       default:
          assert(0);
          break;
@@ -65,7 +65,7 @@ memory_partition_unit::memory_partition_unit( unsigned partition_id,
                                               class memory_stats_t *stats )
 : m_id(partition_id), m_config(config), m_stats(stats), m_arbitration_metadata(config) 
 {
-    m_dram = new dram_t(m_id,m_config,m_stats,this);
+    m_dram = create_dram_backend(m_id,m_config,m_stats,this);
 
     m_sub_partition = new memory_sub_partition*[m_config->m_n_sub_partition_per_memory_channel]; 
     for (unsigned p = 0; p < m_config->m_n_sub_partition_per_memory_channel; p++) {
@@ -242,7 +242,7 @@ void memory_partition_unit::dram_cycle()    // 根据命名，可推知：L2cach
     }
 
     // DRAM latency queue   ”DRAM延时队列“不空 && 当前时间 >= ”DRAM延时队列“队首元素的准备时间（也就是时延） &&  DRAM channel不满
-    if( !m_dram_latency_queue.empty() && ( (gpu_sim_cycle+gpu_tot_sim_cycle) >= m_dram_latency_queue.front().ready_cycle ) && !m_dram->full() ) {
+    if( !m_dram_latency_queue.empty() && ( (gpu_sim_cycle+gpu_tot_sim_cycle) >= m_dram_latency_queue.front().ready_cycle ) && !m_dram->full(m_dram_latency_queue.front().req) ) {
         mem_fetch* mf = m_dram_latency_queue.front().req;   // 取出”DRAM延时队列“队首元素mf
         m_dram_latency_queue.pop_front();                   // 弹出该元素mf
         m_dram->push(mf);                                   // mf放入DRAM channel
@@ -535,6 +535,20 @@ unsigned memory_sub_partition::flushL2()
     return 0; // L2 is read only in this version
 }
 
+void memory_sub_partition::warmL2( new_addr_type addr, bool is_write, unsigned time )
+{
+    if (!m_config->m_L2_config.disabled()) {
+        m_L2cache->warm(addr,is_write,time);
+    }
+}
+
+void memory_sub_partition::finish_warmingL2()
+{
+    if (!m_config->m_L2_config.disabled()) {
+        m_L2cache->finish_warming();
+    }
+}
+
 bool memory_sub_partition::busy() const 
 {
     return !m_request_tracker.empty();
@@ -98,7 +98,7 @@ private:
    const struct memory_config *m_config;
    class memory_stats_t *m_stats;
    class memory_sub_partition **m_sub_partition; 
-   class dram_t *m_dram;
+   class dram_backend *m_dram;
 
     class arbitration_metadata  // 该类里面的操作都是针对主存分区（DRAM channel）的L2 cache
     {
@@ -160,6 +160,8 @@ public:
    void set_done( mem_fetch *mf );
 
    unsigned flushL2();
+   void warmL2( new_addr_type addr, bool is_write, unsigned time );
+   void finish_warmingL2();
 
    // interface to L2_dram_queue
    bool L2_dram_queue_empty() const; 
@@ -0,0 +1,183 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "local_interconnect.h"
+#include "../abstract_hardware_model.h"
+#include <assert.h>
+#include <stdlib.h>
+
+local_xbar_config g_local_xbar_config;
+
+local_crossbar::local_crossbar( const local_xbar_config &config )
+   : m_config(config)
+{
+   assert(m_config.bandwidth > 0 && m_config.flit_size > 0);
+   assert(m_config.in_buffer > 0 && m_config.out_buffer > 0);
+   // the largest packet is a full line of data plus the 8 byte 
+   // READ/WRITE_PACKET_SIZE header; it must fit the input queue or it is 
+   // never accepted
+   unsigned max_packet_flits = n_flits(MAX_MEMORY_ACCESS_SIZE + 8);
+   if (m_config.in_buffer < max_packet_flits) {
+      printf("GPGPU-Sim uArch: ERROR -icnt_xbar_in_buffer (%u flits) is smaller than the largest packet (%u flits of %u bytes)\n",
+             m_config.in_buffer, max_packet_flits, m_config.flit_size);
+      abort();
+   }
+   m_n_waiting = 0;
+   m_n_in_flight = 0;
+   m_rr = 0;
+   m_time = 0;
+   m_packets = m_flits = m_latency_sum = m_latency_max = m_grant_stalls = m_cycles = 0;
+   m_tot_packets = m_tot_flits = m_tot_latency_sum = m_tot_latency_max = m_tot_grant_stalls = m_tot_cycles = 0;
+}
+
+void local_crossbar::create( unsigned n_shader, unsigned n_mem )
+{
+   m_ports.resize(n_shader + n_mem);
+   for (unsigned p=0; p < m_ports.size(); p++) {
+      m_ports[p].in_flits = 0;
+      m_ports[p].in_free_at = 0;
+      m_ports[p].out_free_at = 0;
+   }
+}
+
+// time keeps running across kernel launches, so nothing needs resetting here
+void local_crossbar::init()
+{
+}
+
+bool local_crossbar::has_buffer( unsigned input, unsigned size ) const
+{
+   return m_ports[input].in_flits + n_flits(size) <= m_config.in_buffer;
+}
+
+void local_crossbar::push( unsigned input, unsigned output, void *data, unsigned size )
+{
+   assert(has_buffer(input, size));
+   assert(output < m_ports.size());
+   packet p;
+   p.data = data;
+   p.output = output;
+   p.flits = n_flits(size);
+   p.push_time = m_time;
+   p.ready_time = 0;
+   m_ports[input].in.push_back(p);
+   m_ports[input].in_flits += p.flits;
+   m_n_waiting++;
+}
+
+void *local_crossbar::pop( unsigned output )
+{
+   port &o = m_ports[output];
+   if (o.out.empty() || o.out.front().ready_time > m_time)
+      return NULL;
+   packet p = o.out.front();
+   o.out.pop_front();
+   m_n_in_flight--;
+   unsigned long long latency = m_time - p.push_time;
+   m_packets++;
+   m_flits += p.flits;
+   m_latency_sum += latency;
+   if (latency > m_latency_max)
+      m_latency_max = latency;
+   return p.data;
+}
+
+void local_crossbar::advance()
+{
+   m_cycles++;
+   unsigned n = m_ports.size();
+   for (unsigned i=0; i < n && m_n_waiting; i++) {
+      unsigned in = (m_rr + i) % n;
+      port &src = m_ports[in];
+      if (src.in.empty() || src.in_free_at > m_time)
+         continue;
+      packet &p = src.in.front();
+      port &dst = m_ports[p.output];
+      if (dst.out_free_at > m_time || dst.out.size() >= m_config.out_buffer) {
+         m_grant_stalls++;
+         continue;
+      }
+      unsigned long long xfer = (p.flits + m_config.bandwidth - 1) / m_config.bandwidth;
+      src.in_free_at = dst.out_free_at = m_time + xfer;
+      p.ready_time = m_time + xfer + m_config.latency;
+      src.in_flits -= p.flits;
+      dst.out.push_back(p);
+      src.in.pop_front();
+      m_n_waiting--;
+      m_n_in_flight++;
+   }
+   m_rr = (m_rr + 1) % n;
+   m_time++;
+}
+
+bool local_crossbar::busy() const
+{
+   return m_n_waiting || m_n_in_flight;
+}
+
+void local_crossbar::display_stats() const
+{
+   printf("Crossbar: packets = %llu, flits = %llu\n", m_packets, m_flits);
+   printf("Crossbar: average packet latency = %.4f (max = %llu)\n",
+          m_packets? (double)m_latency_sum / m_packets : 0.0, m_latency_max);
+   printf("Crossbar: accepted flit rate per node = %.4f\n",
+          (m_cycles && m_ports.size())? (double)m_flits / m_cycles / m_ports.size() : 0.0);
+   printf("Crossbar: output conflict stalls = %llu\n", m_grant_stalls);
+}
+
+void local_crossbar::display_overall_stats()
+{
+   m_tot_packets += m_packets;
+   m_tot_flits += m_flits;
+   m_tot_latency_sum += m_latency_sum;
+   if (m_latency_max > m_tot_latency_max)
+      m_tot_latency_max = m_latency_max;
+   m_tot_grant_stalls += m_grant_stalls;
+   m_tot_cycles += m_cycles;
+   m_packets = m_flits = m_latency_sum = m_latency_max = m_grant_stalls = m_cycles = 0;
+
+   printf("Crossbar (overall): packets = %llu, flits = %llu\n", m_tot_packets, m_tot_flits);
+   printf("Crossbar (overall): average packet latency = %.4f (max = %llu)\n",
+          m_tot_packets? (double)m_tot_latency_sum / m_tot_packets : 0.0, m_tot_latency_max);
+   printf("Crossbar (overall): accepted flit rate per node = %.4f\n",
+          (m_tot_cycles && m_ports.size())? (double)m_tot_flits / m_tot_cycles / m_ports.size() : 0.0);
+   printf("Crossbar (overall): output conflict stalls = %llu\n", m_tot_grant_stalls);
+}
+
+void local_crossbar::display_state( FILE *fp ) const
+{
+   fprintf(fp, "Crossbar state @ %llu: %u packets waiting, %u in flight\n", m_time, m_n_waiting, m_n_in_flight);
+   for (unsigned p=0; p < m_ports.size(); p++) {
+      const port &n = m_ports[p];
+      if (n.in.empty() && n.out.empty())
+         continue;
+      fprintf(fp, "  node %u: in = %zu packets (%u flits), out = %zu packets", p, n.in.size(), n.in_flits, n.out.size());
+      if (!n.in.empty())
+         fprintf(fp, ", head -> %u", n.in.front().output);
+      fprintf(fp, "\n");
+   }
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef LOCAL_INTERCONNECT_H
+#define LOCAL_INTERCONNECT_H
+
+#include <stdio.h>
+#include <deque>
+#include <vector>
+
+// Analytical crossbar used by -network_mode 2 in place of intersim2.
+//
+// Every device (SIMT cluster or memory sub-partition) has one input queue
+// and one output port. Requests only travel cluster->memory and replies
+// memory->cluster, so the two directions never share a port and act as two
+// separate subnets. Each cycle, inputs are visited round robin and a head
+// packet is granted when its input and output ports are free and the
+// output has room; the packet then holds both ports for
+// ceil(flits/bandwidth) cycles and can be popped at the destination
+// `latency` cycles after its last flit crossed. There are no routers,
+// virtual channels or per-flit state.
+struct local_xbar_config {
+   unsigned latency;        // cycles from the last flit crossing to the packet being poppable
+   unsigned bandwidth;      // flits per cycle per port
+   unsigned in_buffer;      // input queue depth in flits
+   unsigned out_buffer;     // packets in flight to or waiting at an output
+   unsigned flit_size;      // bytes
+};
+
+extern local_xbar_config g_local_xbar_config;
+
+class local_crossbar {
+public:
+   local_crossbar( const local_xbar_config &config );
+
+   void create( unsigned n_shader, unsigned n_mem );
+   void init();
+   bool has_buffer( unsigned input, unsigned size ) const;
+   void push( unsigned input, unsigned output, void *data, unsigned size );
+   void *pop( unsigned output );
+   void advance();
+   bool busy() const;
+
+   void display_stats() const;
+   void display_overall_stats();
+   void display_state( FILE *fp ) const;
+   unsigned get_flit_size() const { return m_config.flit_size; }
+
+private:
+   struct packet {
+      void *data;
+      unsigned output;
+      unsigned flits;
+      unsigned long long push_time;
+      unsigned long long ready_time;
+   };
+   struct port {
+      std::deque<packet> in;           // waiting to cross, oldest first
+      unsigned in_flits;
+      unsigned long long in_free_at;   // input is sending until then
+      std::deque<packet> out;          // crossed or crossing, ready_time is non-decreasing
+      unsigned long long out_free_at;  // output is receiving until then
+   };
+
+   unsigned n_flits( unsigned size ) const { return (size + m_config.flit_size - 1) / m_config.flit_size; }
+
+   local_xbar_config m_config;
+   std::vector<port> m_ports;
+   unsigned m_n_waiting;                // packets in input queues
+   unsigned m_n_in_flight;              // packets in output queues
+   unsigned m_rr;                       // first input considered next cycle
+   unsigned long long m_time;
+
+   // statistics; the kernel counters are folded into the totals by display_overall_stats()
+   unsigned long long m_packets, m_flits, m_latency_sum, m_latency_max, m_grant_stalls, m_cycles;
+   unsigned long long m_tot_packets, m_tot_flits, m_tot_latency_sum, m_tot_latency_max, m_tot_grant_stalls, m_tot_cycles;
+};
+
+#endif
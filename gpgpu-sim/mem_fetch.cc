@@ -30,8 +30,75 @@
 #include "shader.h"
 #include "visualizer.h"
 #include "gpu-sim.h"
+#include <set>
 
 unsigned mem_fetch::sm_next_mf_request_uid=1;
+bool mem_fetch::sm_pool_debug=false;
+unsigned mem_fetch::sm_pool_live=0;
+unsigned mem_fetch::sm_pool_live_max=0;
+
+// Every memory transaction in flight is a mem_fetch, so they are carved out
+// of slabs and recycled through a free list instead of a heap round-trip each.
+// Slabs are never returned; the pool only grows to the high-water mark.
+union mem_fetch_slot {
+   mem_fetch_slot *m_next_free;
+   unsigned long long m_align;
+   char m_storage[sizeof(mem_fetch)];
+};
+static const unsigned mem_fetch_slab_size = 1024;
+static mem_fetch_slot *g_mem_fetch_free_list = NULL;
+static std::set<void*> g_mem_fetch_live; // only maintained in debug mode
+
+void *mem_fetch::operator new( size_t size )
+{
+   assert( size == sizeof(mem_fetch) );
+   if( g_mem_fetch_free_list == NULL ) {
+      mem_fetch_slot *slab = (mem_fetch_slot*) malloc( mem_fetch_slab_size*sizeof(mem_fetch_slot) );
+      assert( slab );
+      for( unsigned i=0; i < mem_fetch_slab_size; i++ ) {
+         slab[i].m_next_free = g_mem_fetch_free_list;
+         g_mem_fetch_free_list = &slab[i];
+      }
+   }
+   mem_fetch_slot *slot = g_mem_fetch_free_list;
+   g_mem_fetch_free_list = slot->m_next_free;
+   sm_pool_live++;
+   if( sm_pool_live > sm_pool_live_max ) 
+      sm_pool_live_max = sm_pool_live;
+   if( sm_pool_debug ) 
+      g_mem_fetch_live.insert(slot);
+   return slot;
+}
+
+void mem_fetch::operator delete( void *p )
+{
+   if( p == NULL ) 
+      return;
+   if( sm_pool_debug ) {
+      if( g_mem_fetch_live.erase(p) == 0 ) {
+         fflush(stdout);
+         printf("GPGPU-Sim uArch: ERROR ** mem_fetch %p freed twice or not allocated from the pool\n", p);
+         abort();
+      }
+   }
+   assert( sm_pool_live > 0 );
+   sm_pool_live--;
+   mem_fetch_slot *slot = (mem_fetch_slot*) p;
+   slot->m_next_free = g_mem_fetch_free_list;
+   g_mem_fetch_free_list = slot;
+}
+
+void mem_fetch::pool_print_live( FILE *fp )
+{
+   fprintf(fp,"GPGPU-Sim uArch: %u mem_fetch still allocated (high-water mark %u)\n", sm_pool_live, sm_pool_live_max);
+   if( !sm_pool_debug ) 
+      return;
+   unsigned n=0;
+   for( std::set<void*>::iterator i=g_mem_fetch_live.begin(); i!=g_mem_fetch_live.end() && n < 16; i++, n++ ) 
+      ((mem_fetch*)*i)->print(fp,false);
+   if( g_mem_fetch_live.size() > n ) 
+      fprintf(fp,"  ... %u more\n", (unsigned)(g_mem_fetch_live.size()-n));
+}
 
 mem_fetch::mem_fetch( const mem_access_t &access, 
                       const warp_inst_t *inst,
@@ -53,6 +120,7 @@ mem_fetch::mem_fetch( const mem_access_t &access,
    m_tpc = tpc;
    m_wid = wid;
    config->m_address_mapping.addrdec_tlx(access.get_addr(),&m_raw_addr);
+   config->m_address_mapping.record(access.get_addr());
    m_partition_addr = config->m_address_mapping.partition_address(access.get_addr());
    m_type = m_access.is_write()?WRITE_REQUEST:READ_REQUEST;
    m_timestamp = gpu_sim_cycle + gpu_tot_sim_cycle;
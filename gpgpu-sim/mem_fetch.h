@@ -111,6 +111,14 @@ public: // 从主存中取：数据/指令。    自带：warp的id、shader的i
    const memory_config *get_mem_config(){return m_mem_config;}
 
    unsigned get_num_flits(bool simt_to_mem);
+
+   // mem_fetch storage is recycled through a slab-backed free list
+   static void *operator new( size_t size );
+   static void operator delete( void *p );
+   static void pool_set_debug( bool debug ) { sm_pool_debug = debug; }
+   static unsigned pool_live() { return sm_pool_live; }
+   static unsigned pool_live_max() { return sm_pool_live_max; }
+   static void pool_print_live( FILE *fp );
 private:
    // request source information
    unsigned m_request_uid;
@@ -140,6 +148,10 @@ private:
 
    static unsigned sm_next_mf_request_uid;
 
+   static bool sm_pool_debug; // track live fetches to catch leaks and double frees
+   static unsigned sm_pool_live;
+   static unsigned sm_pool_live_max;
+
    const class memory_config *m_mem_config;
    unsigned icnt_flit_size;
 };
@@ -38,6 +38,7 @@ Scoreboard::Scoreboard( unsigned sid, unsigned n_warps )
 	m_sid = sid;
 	//Initialize size of table
 	reg_table.resize(n_warps);
+	m_pending_writes.resize(n_warps,0);
 	longopregs.resize(n_warps);
 }
 
@@ -46,38 +47,40 @@ void Scoreboard::printContents() const
 {
 	printf("scoreboard contents (sid=%d): \n", m_sid);
 	for(unsigned i=0; i<reg_table.size(); i++) {
-		if(reg_table[i].size() == 0 ) continue;
+		if(m_pending_writes[i] == 0 ) continue;
 		printf("  wid = %2d: ", i);
-		std::set<unsigned>::const_iterator it;
-		for( it=reg_table[i].begin() ; it != reg_table[i].end(); it++ )
-			printf("%u ", *it);
+		for( unsigned r=0; r < 64*reg_table[i].size(); r++ )
+			if( test_reg(reg_table[i],r) ) 
+				printf("%u ", r);
 		printf("\n");
 	}
 }
 
 void Scoreboard::reserveRegister(unsigned wid, unsigned regnum) 
 {
-	if( !(reg_table[wid].find(regnum) == reg_table[wid].end()) ){
+	if( test_reg(reg_table[wid],regnum) ){
 		printf("Error: trying to reserve an already reserved register (sid=%d, wid=%d, regnum=%d).", m_sid, wid, regnum);
         abort();
 	}
     SHADER_DPRINTF( SCOREBOARD,
                     "Reserved Register - warp:%d, reg: %d\n", wid, regnum );
-	reg_table[wid].insert(regnum);
+	set_reg(reg_table[wid],regnum);
+	m_pending_writes[wid]++;
 }
 
 // Unmark register as write-pending
 void Scoreboard::releaseRegister(unsigned wid, unsigned regnum) 
 {
-	if( !(reg_table[wid].find(regnum) != reg_table[wid].end()) ) 
+	if( !test_reg(reg_table[wid],regnum) ) 
         return;
     SHADER_DPRINTF( SCOREBOARD,
                     "Release register - warp:%d, reg: %d\n", wid, regnum );
-	reg_table[wid].erase(regnum);
+	clear_reg(reg_table[wid],regnum);
+	m_pending_writes[wid]--;
 }
 
 const bool Scoreboard::islongop (unsigned warp_id,unsigned regnum) {
-	return longopregs[warp_id].find(regnum) != longopregs[warp_id].end();
+	return test_reg(longopregs[warp_id],regnum);
 }
 
 void Scoreboard::reserveRegisters(const class warp_inst_t* inst) 
@@ -106,7 +109,7 @@ void Scoreboard::reserveRegisters(const class warp_inst_t* inst)
                                 "New longopreg marked - warp:%d, reg: %d\n",
                                 inst->warp_id(),
                                 inst->out[r] );
-                longopregs[inst->warp_id()].insert(inst->out[r]);
+                set_reg(longopregs[inst->warp_id()],inst->out[r]);
             }
     	}
     }
@@ -122,7 +125,7 @@ void Scoreboard::releaseRegisters(const class warp_inst_t *inst)
                             inst->warp_id(),
                             inst->out[r] );
             releaseRegister(inst->warp_id(), inst->out[r]);
-            longopregs[inst->warp_id()].erase(inst->out[r]);
+            clear_reg(longopregs[inst->warp_id()],inst->out[r]);
         }
     }
 }
@@ -135,31 +138,22 @@ void Scoreboard::releaseRegisters(const class warp_inst_t *inst)
  **/ 
 bool Scoreboard::checkCollision( unsigned wid, const class inst_t *inst ) const
 {
-	// Get list of all input and output registers
-	std::set<int> inst_regs;
-
-	if(inst->out[0] > 0) inst_regs.insert(inst->out[0]);
-	if(inst->out[1] > 0) inst_regs.insert(inst->out[1]);
-	if(inst->out[2] > 0) inst_regs.insert(inst->out[2]);
-	if(inst->out[3] > 0) inst_regs.insert(inst->out[3]);
-	if(inst->in[0] > 0) inst_regs.insert(inst->in[0]);
-	if(inst->in[1] > 0) inst_regs.insert(inst->in[1]);
-	if(inst->in[2] > 0) inst_regs.insert(inst->in[2]);
-	if(inst->in[3] > 0) inst_regs.insert(inst->in[3]);
-	if(inst->pred > 0) inst_regs.insert(inst->pred);
-	if(inst->ar1 > 0) inst_regs.insert(inst->ar1);
-	if(inst->ar2 > 0) inst_regs.insert(inst->ar2);
-
-	// Check for collision, get the intersection of reserved registers and instruction registers
-	std::set<int>::const_iterator it2;
-	for ( it2=inst_regs.begin() ; it2 != inst_regs.end(); it2++ )
-		if(reg_table[wid].find(*it2) != reg_table[wid].end()) {
-			return true;
-		}
+	// Check every input and output register against the pending-write bitset 
+	// (duplicate operands just test the same bit twice)
+	const reg_bitset_t &pending = reg_table[wid];
+	if( m_pending_writes[wid] == 0 ) 
+		return false;
+	for( unsigned r=0; r < 4; r++ ) {
+		if(inst->out[r] > 0 && test_reg(pending,inst->out[r])) return true;
+		if(inst->in[r] > 0 && test_reg(pending,inst->in[r])) return true;
+	}
+	if(inst->pred > 0 && test_reg(pending,inst->pred)) return true;
+	if(inst->ar1 > 0 && test_reg(pending,inst->ar1)) return true;
+	if(inst->ar2 > 0 && test_reg(pending,inst->ar2)) return true;
 	return false;
 }
 
 bool Scoreboard::pendingWrites(unsigned wid) const
 {
-	return !reg_table[wid].empty();
+	return m_pending_writes[wid] != 0;
 }
@@ -28,7 +28,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <vector>
-#include <set>
 #include "assert.h"
 
 #ifndef SCOREBOARD_H_
@@ -52,13 +51,36 @@ private:
     void reserveRegister(unsigned wid, unsigned regnum);
     int get_sid() const { return m_sid; }
 
+    // register sets are bitsets with one bit per register number; PTX register numbers 
+    // are allocated per function without a fixed bound, so the sets grow on demand
+    typedef std::vector<unsigned long long> reg_bitset_t;
+    static bool test_reg( const reg_bitset_t &regs, unsigned regnum )
+    {
+        unsigned word = regnum >> 6;
+        return word < regs.size() && ((regs[word] >> (regnum & 63)) & 1);
+    }
+    static void set_reg( reg_bitset_t &regs, unsigned regnum )
+    {
+        unsigned word = regnum >> 6;
+        if( word >= regs.size() ) 
+            regs.resize(word+1,0);
+        regs[word] |= 1ULL << (regnum & 63);
+    }
+    static void clear_reg( reg_bitset_t &regs, unsigned regnum )
+    {
+        unsigned word = regnum >> 6;
+        if( word < regs.size() ) 
+            regs[word] &= ~(1ULL << (regnum & 63));
+    }
+
     unsigned m_sid;
 
     // keeps track of pending writes to registers
-    // indexed by warp id, reg_id => pending write count
-    std::vector< std::set<unsigned> > reg_table;
+    // indexed by warp id, bit reg_id set => write pending
+    std::vector<reg_bitset_t> reg_table;
+    std::vector<unsigned> m_pending_writes; // number of bits set in reg_table, per warp
     //Register that depend on a long operation (global, local or tex memory)
-    std::vector< std::set<unsigned> > longopregs;
+    std::vector<reg_bitset_t> longopregs;
 };
 
 
@@ -44,6 +44,7 @@
 #include "icnt_wrapper.h"
 #include <string.h>
 #include <limits.h>
+#include <algorithm>
 #include "traffic_breakdown.h"
 #include "shader_trace.h"
 
@@ -335,6 +336,8 @@ void shader_core_ctx::init_warps( unsigned cta_id, unsigned start_thread, unsign
             m_simt_stack[i]->launch(start_pc,active_threads);
             m_warp[i].init(start_pc,cta_id,i,active_threads, m_dynamic_warp_id);
             ++m_dynamic_warp_id;
+            for ( unsigned s = 0; s < schedulers.size(); s++ ) 
+                schedulers[s]->warp_initialized(i);
             m_not_completed += n_active;
       }
    }
@@ -440,6 +443,8 @@ void shader_core_stats::print( FILE* fout ) const
    fprintf(fout, "gpgpu_stall_shd_mem[l_mem_ld][wb_rsrv_fail] = %d\n", gpu_stall_shd_mem_breakdown[L_MEM_ST][WB_CACHE_RSRV_FAIL]);
 
    fprintf(fout, "gpu_reg_bank_conflict_stalls = %d\n", gpu_reg_bank_conflict_stalls);
+   fprintf(fout, "gpgpu_n_reg_bank_read_conflict = %llu\n", gpgpu_n_reg_bank_read_conflict);
+   fprintf(fout, "gpgpu_n_reg_bank_read_conflict_kernel = %llu\n", gpgpu_n_reg_bank_read_conflict_kernel);
 
    fprintf(fout, "Warp Occupancy Distribution:\n");
    fprintf(fout, "Stall:%d\t", shader_cycle_distro[2]);
@@ -799,6 +804,50 @@ void scheduler_unit::order_by_priority( std::vector< T >& result_list,
     }
 }
 
+void scheduler_unit::warp_initialized(int i)
+{
+    std::vector< shd_warp_t* >::iterator w = std::find( m_age_ordered_warps.begin(),
+                                                        m_age_ordered_warps.end(),
+                                                        &warp(i) );
+    if ( w != m_age_ordered_warps.end() ) {
+        // youngest warp goes to the back
+        std::rotate( w, w + 1, m_age_ordered_warps.end() );
+    }
+}
+
+void scheduler_unit::order_by_age( std::vector< shd_warp_t* >& result_list,
+                                   const std::vector< shd_warp_t* >::const_iterator& last_issued_from_input,
+                                   unsigned num_warps_to_add,
+                                   OrderingType ordering )
+{
+    assert( num_warps_to_add <= m_age_ordered_warps.size() );
+    result_list.clear();
+
+    shd_warp_t* greedy_value = NULL;
+    if ( ORDERING_GREEDY_THEN_PRIORITY_FUNC == ordering ) {
+        greedy_value = *last_issued_from_input;
+        result_list.push_back( greedy_value );
+    } else if ( ORDERED_PRIORITY_FUNC_ONLY != ordering ) {
+        fprintf( stderr, "Unknown ordering - %d\n", ordering );
+        abort();
+    }
+
+    // Warps that are exited or waiting sort behind all others and are skipped by
+    // cycle(), so only the first num_warps_to_add ready warps need to be listed.
+    unsigned count = 0;
+    for ( std::vector< shd_warp_t* >::const_iterator iter = m_age_ordered_warps.begin();
+          iter != m_age_ordered_warps.end() && count < num_warps_to_add;
+          ++iter ) {
+        if ( (*iter)->done_exit() || (*iter)->waiting() ) {
+            continue;
+        }
+        ++count;
+        if ( *iter != greedy_value ) {
+            result_list.push_back( *iter );
+        }
+    }
+}
+
 void scheduler_unit::cycle()
 {
     SCHED_DPRINTF( "scheduler_unit::cycle()\n" );
@@ -952,12 +1001,10 @@ void lrr_scheduler::order_warps()
 
 void gto_scheduler::order_warps()
 {
-    order_by_priority( m_next_cycle_prioritized_warps,
-                       m_supervised_warps,
-                       m_last_supervised_issued,
-                       m_supervised_warps.size(),
-                       ORDERING_GREEDY_THEN_PRIORITY_FUNC,
-                       scheduler_unit::sort_warps_by_oldest_dynamic_id );
+    order_by_age( m_next_cycle_prioritized_warps,
+                  m_last_supervised_issued,
+                  m_supervised_warps.size(),
+                  ORDERING_GREEDY_THEN_PRIORITY_FUNC );
 }
 
 void
@@ -1054,12 +1101,10 @@ swl_scheduler::swl_scheduler ( shader_core_stats* stats, shader_core_ctx* shader
 void swl_scheduler::order_warps()
 {
     if ( SCHEDULER_PRIORITIZATION_GTO == m_prioritization ) {
-        order_by_priority( m_next_cycle_prioritized_warps,
-                           m_supervised_warps,
-                           m_last_supervised_issued,
-                           MIN( m_num_warps_to_limit, m_supervised_warps.size() ),
-                           ORDERING_GREEDY_THEN_PRIORITY_FUNC,
-                           scheduler_unit::sort_warps_by_oldest_dynamic_id );
+        order_by_age( m_next_cycle_prioritized_warps,
+                      m_last_supervised_issued,
+                      MIN( m_num_warps_to_limit, m_supervised_warps.size() ),
+                      ORDERING_GREEDY_THEN_PRIORITY_FUNC );
     } else {
         fprintf(stderr, "swl_scheduler m_prioritization = %d\n", m_prioritization);
         abort();
@@ -1446,6 +1491,18 @@ void ldst_unit::flush(){
 	m_L1D->flush();
 }
 
+void ldst_unit::warm_L1D( new_addr_type addr, bool is_write, unsigned time )
+{
+    if( m_L1D ) 
+        m_L1D->warm(addr,is_write,time);
+}
+
+void ldst_unit::finish_warming_L1D()
+{
+    if( m_L1D ) 
+        m_L1D->finish_warming();
+}
+
 simd_function_unit::simd_function_unit( const shader_core_config *config )
 { 
     m_config=config;
@@ -2458,12 +2515,10 @@ void shader_core_ctx::cache_flush()
 }
 
 // modifiers
-std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads() 
+unsigned opndcoll_rfu_t::arbiter_t::allocate_reads( op_t *result ) 
 {
-   std::list<op_t> result;  // a list of registers that (a) are in different register banks, (b) do not go to the same operand collector
+   // grants registers that (a) are in different register banks, (b) do not go to the same operand collector
 
-   int input;
-   int output;
    int _inputs = m_num_banks;
    int _outputs = m_num_collectors;
    int _square = ( _inputs > _outputs ) ? _inputs : _outputs;
@@ -2471,72 +2526,52 @@ std::list<opndcoll_rfu_t::op_t> opndcoll_rfu_t::arbiter_t::allocate_reads()
    int _pri = (int)m_last_cu;
 
    // Clear matching
-   for ( int i = 0; i < _inputs; ++i ) 
-      _inmatch[i] = -1;
    for ( int j = 0; j < _outputs; ++j ) 
       _outmatch[j] = -1;
 
-   for( unsigned i=0; i<m_num_banks; i++) {
-      for( unsigned j=0; j<m_num_collectors; j++) {
-         assert( i < (unsigned)_inputs );
-         assert( j < (unsigned)_outputs );
-         _request[i][j] = 0;
-      }
-      if( !m_queue[i].empty() ) {
-         const op_t &op = m_queue[i].front();
-         int oc_id = op.get_oc_id();
-         assert( i < (unsigned)_inputs );
-         assert( oc_id < _outputs );
-         _request[i][oc_id] = 1;
-      }
-      if( m_allocated_bank[i].is_write() ) {
-         assert( i < (unsigned)_inputs );
-         _inmatch[i] = 0; // write gets priority
-      }
-   }
-
-   ///// wavefront allocator from booksim... --->
-   
-   // Loop through diagonals of request matrix
-
-   for ( int p = 0; p < _square; ++p ) {
-      output = ( _pri + p ) % _square;
-
-      // Step through the current diagonal
-      for ( input = 0; input < _inputs; ++input ) {
-          assert( input < _inputs );
-          assert( output < _outputs );
-         if ( ( output < _outputs ) && 
-              ( _inmatch[input] == -1 ) && 
-              ( _outmatch[output] == -1 ) &&
-              ( _request[input][output]/*.label != -1*/ ) ) {
-            // Grant!
-            _inmatch[input] = output;
-            _outmatch[output] = input;
-         }
-
-         output = ( output + 1 ) % _square;
+   // Wavefront allocation (as in booksim): diagonal p of the request matrix pairs
+   // input i with output (_pri+p+i)%_square, and diagonals are granted in order.
+   // Each bank (input) requests only the collector unit of the operand at the 
+   // head of its queue, so the input granted an output is simply the requester
+   // whose diagonal comes first; writes to a bank take priority over reads.
+   for ( int input = 0; input < _inputs; ++input ) {
+      if ( m_queue_size[input] == 0 || m_allocated_bank[input].is_write() ) 
+         continue;
+      int output = queue_entry(input,0).get_oc_id();
+      assert( output < _outputs );
+      int p = ( output - _pri - input + 2*_square ) % _square;
+      if ( _outmatch[output] == -1 || p < _outmatch_pri[output] ) {
+         _outmatch[output] = input;
+         _outmatch_pri[output] = p;
       }
    }
 
    // Round-robin the priority diagonal
    _pri = ( _pri + 1 ) % _square;
-
-   /// <--- end code from booksim
-
    m_last_cu = _pri;
+
+   // A bank conflict is a read that loses its bank to another read: when a 
+   // bank grants its head request, the requests still queued behind it lost. 
+   // Each request is counted once, the first time it loses; since requests 
+   // only join at the tail, the counted ones are a prefix of the queue.
+   unsigned n = 0;
+   m_last_read_conflicts = 0;
    for( unsigned i=0; i < m_num_banks; i++ ) {
-      if( _inmatch[i] != -1 ) {
-         if( !m_allocated_bank[i].is_write() ) {
-            unsigned bank = (unsigned)i;
-            op_t &op = m_queue[bank].front();
-            result.push_back(op);
-            m_queue[bank].pop_front();
-         }
+      if( m_queue_size[i] == 0 || m_allocated_bank[i].is_write() ) 
+         continue;
+      const op_t &op = queue_entry(i,0);
+      if( _outmatch[op.get_oc_id()] == (int)i ) {
+         result[n++] = op;
+         m_queue_head[i] = (m_queue_head[i]+1) % m_queue_capacity;
+         m_queue_size[i]--;
+         if( m_queue_conflicted[i] ) 
+            m_queue_conflicted[i]--;
+         m_last_read_conflicts += m_queue_size[i] - m_queue_conflicted[i];
+         m_queue_conflicted[i] = m_queue_size[i];
       }
    }
 
-   return result;
+   return n;
 }
 
 barrier_set_t::barrier_set_t(shader_core_ctx *shader,unsigned max_warps_per_core, unsigned max_cta_per_core, unsigned max_barriers_per_cta, unsigned warp_size)
@@ -2910,14 +2945,18 @@ void shd_warp_t::print_ibuffer( FILE *fout ) const
 }
 
 void opndcoll_rfu_t::add_cu_set(unsigned set_id, unsigned num_cu, unsigned num_dispatch){
-    m_cus[set_id].reserve(num_cu); //this is necessary to stop pointers in m_cu from being invalid do to a resize;
+    if( set_id >= m_cus.size() ) 
+        m_cus.resize(set_id+1,NULL);
+    assert( m_cus[set_id] == NULL );
+    m_cus[set_id] = new std::vector<collector_unit_t>();
+    m_cus[set_id]->reserve(num_cu); //this is necessary to stop pointers in m_cu from being invalid do to a resize;
     for (unsigned i = 0; i < num_cu; i++) {
-        m_cus[set_id].push_back(collector_unit_t());
-        m_cu.push_back(&m_cus[set_id].back());
+        m_cus[set_id]->push_back(collector_unit_t());
+        m_cu.push_back(&m_cus[set_id]->back());
     }
     // for now each collector set gets dedicated dispatch units.
     for (unsigned i = 0; i < num_dispatch; i++) {
-        m_dispatch_units.push_back(dispatch_unit_t(&m_cus[set_id]));
+        m_dispatch_units.push_back(dispatch_unit_t(m_cus[set_id]));
     }
 }
 
@@ -2939,6 +2978,7 @@ void opndcoll_rfu_t::init( unsigned num_banks, shader_core_ctx *shader )
 {
    m_shader=shader;
    m_arbiter.init(m_cu.size(),num_banks);
+   m_read_grants = new op_t[num_banks];
    //for( unsigned n=0; n<m_num_ports;n++ ) 
    //    m_dispatch_units[m_output[n]].init( m_num_collector_units[n] );
    m_num_banks = num_banks;
@@ -2973,6 +3013,7 @@ bool opndcoll_rfu_t::writeback( const warp_inst_t &inst )
       if( m_arbiter.bank_idle(bank) ) {
           m_arbiter.allocate_bank_for_write(bank,op_t(&inst,reg,m_num_banks,m_bank_warp_shift));
       } else {
+          m_shader->increg_bank_conflict_stalls();
           return false;
       }
    }
@@ -3029,7 +3070,7 @@ void opndcoll_rfu_t::allocate_cu( unsigned port_num )
        if( (*inp.m_in[i]).has_ready() ) {
           //find a free cu 
           for (unsigned j = 0; j < inp.m_cu_sets.size(); j++) {
-              std::vector<collector_unit_t> & cu_set = m_cus[inp.m_cu_sets[j]];
+              std::vector<collector_unit_t> & cu_set = *m_cus[inp.m_cu_sets[j]];
 	      bool allocated = false;
               for (unsigned k = 0; k < cu_set.size(); k++) {
                   if(cu_set[k].is_free()) {
@@ -3048,20 +3089,13 @@ void opndcoll_rfu_t::allocate_cu( unsigned port_num )
 
 void opndcoll_rfu_t::allocate_reads()
 {
-   // process read requests that do not have conflicts
-   std::list<op_t> allocated = m_arbiter.allocate_reads();
-   std::map<unsigned,op_t> read_ops;
-   for( std::list<op_t>::iterator r=allocated.begin(); r!=allocated.end(); r++ ) {
-      const op_t &rr = *r;
-      unsigned reg = rr.get_reg();
-      unsigned wid = rr.get_wid();
-      unsigned bank = register_bank(reg,wid,m_num_banks,m_bank_warp_shift);
-      m_arbiter.allocate_for_read(bank,rr);
-      read_ops[bank] = rr;
-   }
-   std::map<unsigned,op_t>::iterator r;
-   for(r=read_ops.begin();r!=read_ops.end();++r ) {
-      op_t &op = r->second;
+   // process read requests that do not have conflicts (granted in bank order)
+   unsigned num_granted = m_arbiter.allocate_reads(m_read_grants);
+   m_shader->increg_bank_read_conflicts(m_arbiter.last_read_conflicts());
+   for( unsigned g=0; g < num_granted; g++ ) {
+      op_t &op = m_read_grants[g];
+      unsigned bank = register_bank(op.get_reg(),op.get_wid(),m_num_banks,m_bank_warp_shift);
+      m_arbiter.allocate_for_read(bank,op);
       unsigned cu = op.get_oc_id();
       unsigned operand = op.get_operand();
       m_cu[cu]->collect_operand(operand);
@@ -3256,6 +3290,17 @@ void simt_core_cluster::cache_flush()
         m_core[i]->cache_flush();
 }
 
+void simt_core_cluster::warm_L1D( unsigned sid, new_addr_type addr, bool is_write, unsigned time )
+{
+    m_core[m_config->sid_to_cid(sid)]->warm_L1D(addr,is_write,time);
+}
+
+void simt_core_cluster::finish_warming_L1D()
+{
+    for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) 
+        m_core[i]->finish_warming_L1D();
+}
+
 bool simt_core_cluster::icnt_injection_buffer_full(unsigned size, bool write)
 {
     unsigned request_size = size;
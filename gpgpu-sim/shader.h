@@ -313,10 +313,14 @@ public:
     virtual ~scheduler_unit(){}
     virtual void add_supervised_warp_id(int i) {
         m_supervised_warps.push_back(&warp(i));
+        m_age_ordered_warps.push_back(&warp(i));
     }
     virtual void done_adding_supervised_warps() {
         m_last_supervised_issued = m_supervised_warps.end();
     }
+    // Called when warp i is (re)initialized with a new CTA and so receives the
+    // youngest dynamic warp id in the core.
+    void warp_initialized(int i);
 
 
     // The core scheduler cycle method is meant to be common between
@@ -351,6 +355,14 @@ public:
                             bool (*priority_func)(U lhs, U rhs) );
     static bool sort_warps_by_oldest_dynamic_id(shd_warp_t* lhs, shd_warp_t* rhs);
 
+    // Same ordering as order_by_priority with sort_warps_by_oldest_dynamic_id, but
+    // built from m_age_ordered_warps instead of sorting, and leaving out warps
+    // that cannot issue this cycle (exited or waiting).
+    void order_by_age( std::vector< shd_warp_t* >& result_list,
+                       const std::vector< shd_warp_t* >::const_iterator& last_issued_from_input,
+                       unsigned num_warps_to_add,
+                       OrderingType ordering );
+
     // Derived classes can override this function to populate
     // m_supervised_warps with their scheduling policies
     virtual void order_warps() = 0;
@@ -373,6 +385,9 @@ protected:
     std::vector< shd_warp_t* > m_supervised_warps;
     // This is the iterator pointer to the last supervised warp you issued
     std::vector< shd_warp_t* >::const_iterator m_last_supervised_issued;
+    // m_supervised_warps ordered oldest dynamic warp id first. Dynamic warp ids are
+    // handed out in increasing order, so this only changes when a warp is initialized.
+    std::vector< shd_warp_t* > m_age_ordered_warps;
     shader_core_stats *m_stats;
     shader_core_ctx* m_shader;
     // these things should become accessors: but would need a bigger rearchitect of how shader_core_ctx interacts with its parts.
@@ -504,6 +519,7 @@ public:
       m_num_banks=0;
       m_shader=NULL;
       m_initialized=false;
+      m_read_grants=NULL;
    }
    void add_cu_set(unsigned cu_set, unsigned num_cu, unsigned num_dispatch);
    typedef std::vector<register_set*> port_vector_t;
@@ -665,12 +681,16 @@ private:
       arbiter_t()
       {
          m_queue=NULL;
+         m_queue_head=NULL;
+         m_queue_size=NULL;
+         m_queue_conflicted=NULL;
+         m_queue_capacity=0;
          m_allocated_bank=NULL;
          m_allocator_rr_head=NULL;
-         _inmatch=NULL;
          _outmatch=NULL;
-         _request=NULL;
+         _outmatch_pri=NULL;
          m_last_cu=0;
+         m_last_read_conflicts=0;
       }
       void init( unsigned num_cu, unsigned num_banks ) 
       { 
@@ -678,12 +698,20 @@ private:
          assert(num_banks > 0);
          m_num_collectors = num_cu;
          m_num_banks = num_banks;
-         _inmatch = new int[ m_num_banks ];
          _outmatch = new int[ m_num_collectors ];
-         _request = new int*[ m_num_banks ];
-         for(unsigned i=0; i<m_num_banks;i++) 
-             _request[i] = new int[m_num_collectors];
-         m_queue = new std::list<op_t>[num_banks];
+         _outmatch_pri = new int[ m_num_collectors ];
+         // a collector unit holds at most MAX_REG_OPERANDS source operands until 
+         // all of them are read, which bounds the requests queued at any bank
+         m_queue_capacity = num_cu*MAX_REG_OPERANDS;
+         m_queue = new op_t[num_banks*m_queue_capacity];
+         m_queue_head = new unsigned[num_banks];
+         m_queue_size = new unsigned[num_banks];
+         m_queue_conflicted = new unsigned[num_banks];
+         for( unsigned b=0; b<num_banks; b++ ) {
+            m_queue_head[b] = 0;
+            m_queue_size[b] = 0;
+            m_queue_conflicted[b] = 0;
+         }
          m_allocated_bank = new allocation_t[num_banks];
          m_allocator_rr_head = new unsigned[num_cu];
          for( unsigned n=0; n<num_cu;n++ ) 
@@ -699,10 +727,8 @@ private:
          fprintf(fp,"  requests:\n");
          for( unsigned b=0; b<m_num_banks; b++ ) {
             fprintf(fp,"    bank %u : ", b );
-            std::list<op_t>::const_iterator o = m_queue[b].begin();
-            for(; o != m_queue[b].end(); o++ ) {
-               o->dump(fp);
-            }
+            for( unsigned n=0; n < m_queue_size[b]; n++ ) 
+               queue_entry(b,n).dump(fp);
             fprintf(fp,"\n");
          }
          fprintf(fp,"  grants:\n");
@@ -713,8 +739,15 @@ private:
          fprintf(fp,"\n");
       }
 
+      // read requests that lost their bank to another read for the first time
+      // in the last allocate_reads()
+      unsigned last_read_conflicts() const { return m_last_read_conflicts; }
+
       // modifiers
-      std::list<op_t> allocate_reads(); 
+
+      // grants at most one queued read per bank and per collector unit; the granted
+      // operands are written to 'result' (room for one per bank), returns how many
+      unsigned allocate_reads( op_t *result ); 
 
       void add_read_requests( collector_unit_t *cu ) 
       {
@@ -723,7 +756,9 @@ private:
             const op_t &op = src[i];
             if( op.valid() ) {
                unsigned bank = op.get_bank();
-               m_queue[bank].push_back(op);
+               assert( m_queue_size[bank] < m_queue_capacity );
+               queue_entry(bank,m_queue_size[bank]) = op;
+               m_queue_size[bank]++;
             }
          }
       }
@@ -748,18 +783,35 @@ private:
       }
 
    private:
+      // n-th oldest request queued at bank b
+      op_t &queue_entry( unsigned b, unsigned n ) 
+      {
+         return m_queue[ b*m_queue_capacity + (m_queue_head[b]+n)%m_queue_capacity ];
+      }
+      const op_t &queue_entry( unsigned b, unsigned n ) const
+      {
+         return m_queue[ b*m_queue_capacity + (m_queue_head[b]+n)%m_queue_capacity ];
+      }
+
       unsigned m_num_banks;
       unsigned m_num_collectors;
 
       allocation_t *m_allocated_bank; // bank # -> register that wins
-      std::list<op_t> *m_queue;
+
+      // per bank fixed-capacity ring of pending read requests, stored back to back
+      op_t *m_queue;
+      unsigned *m_queue_head;
+      unsigned *m_queue_size;
+      unsigned *m_queue_conflicted; // leading requests of each queue already counted as a bank conflict
+      unsigned m_queue_capacity;
 
       unsigned *m_allocator_rr_head; // cu # -> next bank to check for request (rr-arb)
       unsigned  m_last_cu; // first cu to check while arb-ing banks (rr)
 
-      int *_inmatch;
-      int *_outmatch;
-      int **_request;
+      int *_outmatch;     // cu # -> bank granted this cycle (-1: none)
+      int *_outmatch_pri; // cu # -> wavefront diagonal of that grant
+
+      unsigned m_last_read_conflicts;
    };
 
    class input_port_t {
@@ -882,8 +934,9 @@ private:
    //warp_inst_t **m_alu_port;
 
    std::vector<input_port_t> m_in_ports;
-   typedef std::map<unsigned /* collector set */, std::vector<collector_unit_t> /*collector sets*/ > cu_sets_t;
+   typedef std::vector< std::vector<collector_unit_t>* > cu_sets_t; // indexed by collector set id
    cu_sets_t m_cus;
+   op_t *m_read_grants; // scratch for m_arbiter.allocate_reads(), one entry per bank
    std::vector<dispatch_unit_t> m_dispatch_units;
 
    //typedef std::map<warp_inst_t**/*port*/,dispatch_unit_t> port_to_du_t;
@@ -1091,6 +1144,8 @@ public:
      
     void fill( mem_fetch *mf );
     void flush();
+    void warm_L1D( new_addr_type addr, bool is_write, unsigned time );
+    void finish_warming_L1D();
     void writeback();
 
     // accessors
@@ -1381,6 +1436,8 @@ struct shader_core_stats_pod {
     unsigned gpgpu_n_cmem_portconflict;
     unsigned gpu_stall_shd_mem_breakdown[N_MEM_STAGE_ACCESS_TYPE][N_MEM_STAGE_STALL_TYPE];
     unsigned gpu_reg_bank_conflict_stalls;
+    unsigned long long gpgpu_n_reg_bank_read_conflict;
+    unsigned long long gpgpu_n_reg_bank_read_conflict_kernel; // reset at kernel launch
     unsigned *shader_cycle_distro;
     unsigned *last_shader_cycle_distro;
     unsigned *num_warps_issuable;
@@ -1479,6 +1536,7 @@ public:
 
     void new_grid()
     {
+        gpgpu_n_reg_bank_read_conflict_kernel = 0;
     }
 
     void event_warp_issued( unsigned s_id, unsigned warp_id, unsigned num_issued, unsigned dynamic_warp_id );
@@ -1575,6 +1633,8 @@ public:
     void reinit(unsigned start_thread, unsigned end_thread, bool reset_not_completed );
     void issue_block2core( class kernel_info_t &kernel );
     void cache_flush();
+    void warm_L1D( new_addr_type addr, bool is_write, unsigned time ) { m_ldst_unit->warm_L1D(addr,is_write,time); }
+    void finish_warming_L1D() { m_ldst_unit->finish_warming_L1D(); }
     void accept_fetch_response( mem_fetch *mf );
     void accept_ldst_unit_response( class mem_fetch * mf );
     void broadcast_barrier_reduction(unsigned cta_id, unsigned bar_id,warp_set_t warps);
@@ -1727,6 +1787,8 @@ public:
 	 void incregfile_reads(unsigned active_count) {m_stats->m_read_regfile_acesses[m_sid]=m_stats->m_read_regfile_acesses[m_sid]+active_count;}
 	 void incregfile_writes(unsigned active_count){m_stats->m_write_regfile_acesses[m_sid]=m_stats->m_write_regfile_acesses[m_sid]+active_count;}
 	 void incnon_rf_operands(unsigned active_count){m_stats->m_non_rf_operands[m_sid]=m_stats->m_non_rf_operands[m_sid]+active_count;}
+	 void increg_bank_read_conflicts(unsigned n) {m_stats->gpgpu_n_reg_bank_read_conflict+=n; m_stats->gpgpu_n_reg_bank_read_conflict_kernel+=n;}
+	 void increg_bank_conflict_stalls() {m_stats->gpu_reg_bank_conflict_stalls++;}
 
 	 void incspactivelanes_stat(unsigned active_count) {m_stats->m_active_sp_lanes[m_sid]=m_stats->m_active_sp_lanes[m_sid]+active_count;}
 	 void incsfuactivelanes_stat(unsigned active_count) {m_stats->m_active_sfu_lanes[m_sid]=m_stats->m_active_sfu_lanes[m_sid]+active_count;}
@@ -1848,6 +1910,8 @@ public:
     void reinit();
     unsigned issue_block2core();
     void cache_flush();
+    void warm_L1D( unsigned sid, new_addr_type addr, bool is_write, unsigned time );
+    void finish_warming_L1D();
     bool icnt_injection_buffer_full(unsigned size, bool write);
     void icnt_inject_request_packet(class mem_fetch *mf);
 
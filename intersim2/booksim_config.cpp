@@ -265,6 +265,8 @@ BookSimConfig::BookSimConfig( )
 
   _int_map["seed"]            = 0; //random seed for simulation, e.g. traffic 
 
+  _int_map["network_threads"] = 1; // threads evaluating the routers of a network; with more than one, each router uses its own random stream
+
   _int_map["print_activity"] = 0;
 
   _int_map["print_csv_results"] = 0;
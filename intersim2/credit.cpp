@@ -33,8 +33,9 @@
 #include "booksim.hpp"
 #include "credit.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+SlabPool<Credit> Credit::_pool;
+bool Credit::_thread_safe = false;
+pthread_mutex_t Credit::_lock = PTHREAD_MUTEX_INITIALIZER;
 
 Credit::Credit()
 {
@@ -50,30 +51,28 @@ void Credit::Reset()
 }
 
 Credit * Credit::New() {
-  Credit * c;
-  if(_free.empty()) {
-    c = new Credit();
-    _all.push(c);
-  } else {
-    c = _free.top();
-    c->Reset();
-    _free.pop();
-  }
+  if(_thread_safe) pthread_mutex_lock(&_lock);
+  Credit * const c = _pool.Allocate();
+  if(_thread_safe) pthread_mutex_unlock(&_lock);
+  c->Reset();
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  if(_thread_safe) pthread_mutex_lock(&_lock);
+  _pool.Release(this);
+  if(_thread_safe) pthread_mutex_unlock(&_lock);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  _pool.FreeAll();
 }
 
 
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  return _pool.Outstanding();
+}
+
+bool Credit::ReclaimAll() {
+  return _pool.ReclaimAll();
 }
@@ -29,7 +29,9 @@
 #define _CREDIT_HPP_
 
 #include <set>
-#include <stack>
+#include <pthread.h>
+
+#include "slab_pool.hpp"
 
 class Credit {
 
@@ -47,10 +49,20 @@ public:
   void Free();
   static void FreeAll();
   static int OutStanding();
+  // returns the pool to allocation order once every credit has been freed
+  static bool ReclaimAll();
+  // routers evaluated on worker threads allocate and free credits
+  // concurrently; the pool is only locked once this has been enabled
+  static void SetThreadSafe( bool thread_safe ) { _thread_safe = thread_safe; }
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  friend class SlabPool<Credit>;
+
+  static SlabPool<Credit> _pool;
+  static bool _thread_safe;
+  static pthread_mutex_t _lock;
+
+  int _index;
 
   Credit();
   ~Credit() {}
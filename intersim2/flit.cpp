@@ -37,8 +37,7 @@
 #include "booksim.hpp"
 #include "flit.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+SlabPool<Flit> Flit::_pool;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -83,25 +82,23 @@ void Flit::Reset()
 }  
 
 Flit * Flit::New() {
-  Flit * f;
-  if(_free.empty()) {
-    f = new Flit;
-    _all.push(f);
-  } else {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
-  }
+  Flit * f = _pool.Allocate();
+  f->Reset();
   return f;
 }
 
 void Flit::Free() {
-  _free.push(this);
+  _pool.Release(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  _pool.FreeAll();
+}
+
+int Flit::OutStanding() {
+  return _pool.Outstanding();
+}
+
+bool Flit::ReclaimAll() {
+  return _pool.ReclaimAll();
 }
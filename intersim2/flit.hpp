@@ -29,10 +29,10 @@
 #define _FLIT_HPP_
 
 #include <iostream>
-#include <stack>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
+#include "slab_pool.hpp"
 
 class Flit {
 
@@ -44,31 +44,24 @@ public:
 		  WRITE_REQUEST = 2,
 		  WRITE_REPLY   = 3,
                   ANY_TYPE      = 4 };
-  FlitType type;
-
-  int vc;
 
-  int cl;
+  // the fields routers look at on every hop fill the first 64 bytes
+  int  vc;
+  int  dest;
+  int  pid;
+  int  id;
+  int  cl;
 
   bool head;
   bool tail;
-  
-  int  ctime;
-  int  itime;
-  int  atime;
-
-  int  id;
-  int  pid;
-
+  bool watch;
   bool record;
 
-  int  src;
-  int  dest;
+  FlitType type;
 
+  int  src;
   int  pri;
-
   int  hops;
-  bool watch;
   int  subnetwork;
   
   // intermediate destination (if any)
@@ -77,6 +70,10 @@ public:
   // phase in multi-phase algorithms
   mutable int ph;
 
+  int  ctime;
+  int  itime;
+  int  atime;
+
   // Fields for arbitrary data
   void* data ;
 
@@ -88,14 +85,20 @@ public:
   static Flit * New();
   void Free();
   static void FreeAll();
+  static int OutStanding();
+  // returns the pool to allocation order once every flit has been freed
+  static bool ReclaimAll();
 
 private:
 
+  friend class SlabPool<Flit>;
+
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  int _index;
+
+  static SlabPool<Flit> _pool;
 
 };
 
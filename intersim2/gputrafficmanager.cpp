@@ -47,6 +47,13 @@ GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<
       _input_queue[subnet][node].resize(_classes);
     }
   }
+  
+  // only the input-queued router is known to do nothing while it has no
+  // flits or credits
+  _skip_idle = ( config.GetStr("router") == "iq" );
+  _idle_settle_steps = (int)ceil( 1.0 / config.GetFloat("internal_speedup") );
+  _idle_steps = 0;
+  _skipped_steps = 0;
 }
 
 GPUTrafficManager::~GPUTrafficManager()
@@ -105,10 +112,8 @@ void GPUTrafficManager::_RetireFlit( Flit *f, int dest )
     if(f->head) {
       head = f;
     } else {
-      map<int, Flit *>::iterator iter = _retired_packets[f->cl].find(f->pid);
-      assert(iter != _retired_packets[f->cl].end());
-      head = iter->second;
-      _retired_packets[f->cl].erase(iter);
+      head = _retired_packets[f->cl].Remove(f->pid);
+      assert(head);
       assert(head->head);
       assert(f->pid == head->pid);
     }
@@ -178,11 +183,37 @@ void GPUTrafficManager::_RetireFlit( Flit *f, int dest )
   }
   
   if(f->head && !f->tail) {
-    _retired_packets[f->cl].insert(make_pair(f->pid, f));
+    _retired_packets[f->cl].Insert(f->pid, f);
   } else {
     f->Free();
   }
 }
+bool GPUTrafficManager::_NothingOutstanding() const
+{
+  for(int c = 0; c < _classes; ++c) {
+    if(!_total_in_flight_flits[c].empty()) {
+      return false;
+    }
+  }
+  return Credit::OutStanding() == 0;
+}
+
+bool GPUTrafficManager::Idle() const
+{
+  return _skip_idle && ( _idle_steps >= _idle_settle_steps ) && _NothingOutstanding();
+}
+
+void GPUTrafficManager::SkipIdleStep()
+{
+  assert(Idle());
+  ++_skipped_steps;
+  ++_time;
+  assert(_time);
+  if(gTrace){
+    cout<<"TIME "<<_time<<endl;
+  }
+}
+
 int  GPUTrafficManager::_IssuePacket( int source, int cl )
 {
   return 0;
@@ -275,7 +306,6 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
     f->ctime  = time;
     f->record = record;
     f->cl     = cl;
-    f->data = data;
     
     _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
     if(record) {
@@ -291,6 +321,8 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
       f->head = true;
       //packets are only generated to nodes smaller or equal to limit
       f->dest = packet_destination;
+      // the boundary buffer takes the packet's data from its head flit
+      f->data = data;
     } else {
       f->head = false;
       f->dest = -1;
@@ -334,6 +366,18 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
 
 void GPUTrafficManager::_Step()
 {
+  if(_skipped_steps) {
+    for(int subnet = 0; subnet < _subnets; ++subnet) {
+      _net[subnet]->IdleCycles(_skipped_steps);
+    }
+    _skipped_steps = 0;
+  }
+  if(_NothingOutstanding()) {
+    ++_idle_steps;
+  } else {
+    _idle_steps = 0;
+  }
+  
   bool flits_in_flight = false;
   for(int c = 0; c < _classes; ++c) {
     flits_in_flight |= !_total_in_flight_flits[c].empty();
@@ -343,8 +387,6 @@ void GPUTrafficManager::_Step()
     cout << "WARNING: Possible network deadlock.\n";
   }
   
-  vector<map<int, Flit *> > flits(_subnets);
-  
   for ( int subnet = 0; subnet < _subnets; ++subnet ) {
     for ( int n = 0; n < _nodes; ++n ) {
       Flit * const f = _net[subnet]->ReadFlit( n );
@@ -373,7 +415,7 @@ void GPUTrafficManager::_Step()
           << " VC " << ejected_flit->vc << ")"
           << "from ejection buffer." << endl;
         }
-        flits[subnet].insert(make_pair(n, ejected_flit));
+        _step_flits[subnet * _nodes + n] = ejected_flit;
         if((_sim_state == warming_up) || (_sim_state == running)) {
           ++_accepted_flits[ejected_flit->cl][n];
           if(ejected_flit->tail) {
@@ -637,9 +679,9 @@ void GPUTrafficManager::_Step()
   //Send the credit To the network
   for(int subnet = 0; subnet < _subnets; ++subnet) {
     for(int n = 0; n < _nodes; ++n) {
-      map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-      if(iter != flits[subnet].end()) {
-        Flit * const f = iter->second;
+      Flit * const f = _step_flits[subnet * _nodes + n];
+      if(f) {
+        _step_flits[subnet * _nodes + n] = NULL;
 
         f->atime = _time;
         if(f->watch) {
@@ -660,7 +702,6 @@ void GPUTrafficManager::_Step()
         _RetireFlit(f, n);
       }
     }
-    flits[subnet].clear();
     // _InteralStep here
     _net[subnet]->Evaluate( );
     _net[subnet]->WriteOutputs( );
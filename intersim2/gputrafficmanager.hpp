@@ -31,6 +31,7 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <cmath>
 
 #include "config_utils.hpp"
 #include "stats.hpp"
@@ -50,6 +51,17 @@ protected:
   // record size of _partial_packets for each subnet
   vector<vector<vector<list<Flit *> > > > _input_queue;
   
+  // idle network fast path: once the networks have been stepped with
+  // nothing in them for _idle_settle_steps cycles (long enough for every
+  // router to see that and go inactive), further idle cycles only advance
+  // the clock. The routers' cycle accumulators catch up on the next _Step.
+  bool _skip_idle;
+  int _idle_settle_steps;
+  int _idle_steps;      // consecutive steps that started with nothing outstanding
+  int _skipped_steps;   // idle cycles the routers have not been told about yet
+  
+  bool _NothingOutstanding() const;
+  
 public:
   
   GPUTrafficManager( const Configuration &config, const vector<Network *> & net );
@@ -58,6 +70,11 @@ public:
   // correspond to TrafficManger::Run/SingleSim
   void Init();
   
+  // true when stepping the networks would only advance the clock
+  bool Idle() const;
+  // use instead of _Step when Idle()
+  void SkipIdleStep();
+  
   // TODO: if it is not good...
   friend class InterconnectInterface;
   
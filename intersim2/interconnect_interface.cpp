@@ -40,6 +40,7 @@
 #include "power_module.hpp"
 #include "mem_fetch.h"
 #include "flit.hpp"
+#include "credit.hpp"
 #include "gputrafficmanager.hpp"
 #include "booksim.hpp"
 #include "intersim_config.hpp"
@@ -139,6 +140,10 @@ void InterconnectInterface::CreateInterconnect(unsigned n_shader, unsigned n_mem
 void InterconnectInterface::Init()
 {
   _traffic_manager->Init();
+  // kernel boundary: if the networks drained, hand flits and credits out in
+  // address order again
+  Flit::ReclaimAll();
+  Credit::ReclaimAll();
   // TODO: Should we init _round_robin_turn?
   //       _boundary_buffer, _ejection_buffer and _ejected_flit_queue should be cleared
 }
@@ -222,7 +227,16 @@ void* InterconnectInterface::Pop(unsigned deviceID)
 
 void InterconnectInterface::Advance()
 {
-  _traffic_manager->_Step();
+  if (_traffic_manager->Idle()) {
+    _traffic_manager->SkipIdleStep();
+  } else {
+    _traffic_manager->_Step();
+  }
+}
+
+bool InterconnectInterface::Idle() const
+{
+  return _traffic_manager->Idle();
 }
 
 bool InterconnectInterface::Busy() const
@@ -324,7 +338,7 @@ void InterconnectInterface::Transfer2BoundaryBuffer(int subnet, int output)
       assert(flit);
 
       _ejection_buffer[subnet][output][vc].pop();
-      _boundary_buffer[subnet][output][vc].PushFlitData( flit->data, flit->tail);
+      _boundary_buffer[subnet][output][vc].PushFlit( flit->data, flit->head, flit->tail);
 
       _ejected_flit_queue[subnet][output].push(flit); //indicate this flit is already popped from ejection buffer and ready for credit return
 
@@ -380,6 +394,9 @@ void InterconnectInterface::_CreateBuffer()
     for (unsigned node=0;node < nodes;++node){
       _ejection_buffer[subnet][node].resize(_vcs);
       _boundary_buffer[subnet][node].resize(_vcs);
+      for (int vc=0;vc<_vcs;++vc){
+        _boundary_buffer[subnet][node][vc].SetCapacity(_boundary_buffer_capacity);
+      }
     }
   }
 }
@@ -500,39 +517,39 @@ void InterconnectInterface::_DisplayMap(int dim,int count)
 void* InterconnectInterface::_BoundaryBufferItem::PopPacket()
 {
   assert (_packet_n);
-  void * data = NULL;
-  void * flit_data = _buffer.front();
-  while (data == NULL) {
-    assert(flit_data == _buffer.front()); //all flits must belong to the same packet
-    if (_tail_flag.front()) {
-      data = _buffer.front();
-      _packet_n--;
-    }
-    _buffer.pop();
-    _tail_flag.pop();
-  }
+  // packets complete in order, so the oldest one is complete
+  const _Packet &p = _ring[_front];
+  void * data = p.data;
+  _flits -= p.flits;
+  if (++_front == _ring.size()) _front = 0;
+  _count--;
+  _packet_n--;
   return data;
 }
 
 void* InterconnectInterface::_BoundaryBufferItem::TopPacket() const
 {
   assert (_packet_n);
-  void* data = NULL;
-  void* temp_d = _buffer.front();
-  while (data==NULL) {
-    if (_tail_flag.front()) {
-      data = _buffer.front();
-    }
-    assert(temp_d == _buffer.front()); //all flits must belong to the same packet
-  }
-  return data;
-
+  return _ring[_front].data;
 }
 
-void InterconnectInterface::_BoundaryBufferItem::PushFlitData(void* data,bool is_tail)
+void InterconnectInterface::_BoundaryBufferItem::PushFlit(void* data, bool is_head, bool is_tail)
 {
-  _buffer.push(data);
-  _tail_flag.push(is_tail);
+  if (is_head) {
+    assert(data);
+    assert(_count == _packet_n); //previous packet must have seen its tail
+    assert(_count < _ring.size());
+    unsigned back = _front + _count;
+    if (back >= _ring.size()) back -= _ring.size();
+    _ring[back].data = data;
+    _ring[back].flits = 0;
+    _count++;
+  }
+  assert(_count > _packet_n); //flit must belong to the packet still arriving
+  unsigned back = _front + _count - 1;
+  if (back >= _ring.size()) back -= _ring.size();
+  _ring[back].flits++;
+  _flits++;
   if (is_tail) {
     _packet_n++;
   }
@@ -57,6 +57,8 @@ public:
   virtual void* Pop(unsigned ouput_deviceID);
   virtual void Advance();
   virtual bool Busy() const;
+  // no flits or credits in the network: Advance() only moves the clock
+  virtual bool Idle() const;
   virtual bool HasBuffer(unsigned deviceID, unsigned int size) const;
   virtual void DisplayStats() const;
   virtual void DisplayOverallStats() const;
@@ -76,19 +78,31 @@ public:
   
 protected:
   
+  // Ring of packets waiting to be popped at one (subnet, node, vc). A packet
+  // is stored once, as the data handle of its head flit; the body and tail
+  // flits only bump counters. Size() is still in flits so that
+  // boundary_buffer_size keeps its meaning.
   class _BoundaryBufferItem {
   public:
-    _BoundaryBufferItem():_packet_n(0) {}
-    inline unsigned Size(void) const { return _buffer.size(); }
+    _BoundaryBufferItem():_front(0),_count(0),_flits(0),_packet_n(0) {}
+    void SetCapacity(unsigned capacity) { _ring.resize(capacity); }
+    inline unsigned Size(void) const { return _flits; }
     inline bool HasPacket() const { return _packet_n; }
     void* PopPacket();
     void* TopPacket() const;
-    void PushFlitData(void* data,bool is_tail);
+    void PushFlit(void* data, bool is_head, bool is_tail);
     
   private:
-    queue<void *> _buffer;
-    queue<bool> _tail_flag;
-    int _packet_n;
+    struct _Packet {
+      void * data;
+      unsigned flits;
+    };
+    // every packet holds at least one flit, so capacity in flits bounds it
+    vector<_Packet> _ring;
+    unsigned _front;
+    unsigned _count; // packets in the ring, including one still arriving
+    unsigned _flits;
+    unsigned _packet_n; // complete packets
   };
   typedef queue<Flit*> _EjectionBufferItem;
   
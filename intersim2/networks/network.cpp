@@ -48,6 +48,8 @@
 #include "anynet.hpp"
 #include "dragonfly.hpp"
 
+ThreadPool * Network::_thread_pool = NULL;
+
 
 Network::Network( const Configuration &config, const string & name ) :
   TimedModule( 0, name )
@@ -56,6 +58,12 @@ Network::Network( const Configuration &config, const string & name ) :
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+  _threads  = config.GetInt("network_threads");
+  _seed     = config.GetInt("seed");
+  _threads_ready = false;
+  if ( _threads < 1 ) {
+    Error( "network_threads must be at least 1." );
+  }
 }
 
 Network::~Network( )
@@ -179,8 +187,80 @@ void Network::_Alloc( )
   }
 }
 
+void Network::_SetupThreads( )
+{
+  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+      iter != _timed_modules.end();
+      ++iter) {
+    if ( dynamic_cast<Router *>(*iter) ) {
+      _parallel_modules.push_back(*iter);
+    } else {
+      _serial_modules.push_back(*iter);
+    }
+  }
+
+  // seed every stream from the module's full name so that the streams of
+  // different networks differ and do not depend on construction order
+  _streams.resize(_parallel_modules.size());
+  for ( size_t i = 0; i < _parallel_modules.size(); ++i ) {
+    string const & name = _parallel_modules[i]->FullName();
+    unsigned long long h = 14695981039346656037ULL;
+    for ( size_t c = 0; c < name.size(); ++c ) {
+      h = ( h ^ (unsigned char)name[c] ) * 1099511628211ULL;
+    }
+    _streams[i].Seed( h ^ (unsigned long long)_seed );
+  }
+
+  // all networks share one pool; only one of them steps at a time
+  if ( !_thread_pool ) {
+    _thread_pool = new ThreadPool( _threads );
+  }
+  Credit::SetThreadSafe( true );
+  _threads_ready = true;
+}
+
+void Network::_StepModule( void * net, int index )
+{
+  Network * const n = static_cast<Network *>(net);
+  TimedModule * const m = n->_parallel_modules[index];
+  RandomSelectStream( &n->_streams[index] );
+  switch ( n->_phase ) {
+  case PHASE_READ_INPUTS:   m->ReadInputs( );   break;
+  case PHASE_EVALUATE:      m->Evaluate( );     break;
+  case PHASE_WRITE_OUTPUTS: m->WriteOutputs( ); break;
+  }
+  RandomSelectStream( NULL );
+}
+
+void Network::_ParallelStep( Phase phase )
+{
+  if ( !_threads_ready ) {
+    _SetupThreads( );
+  }
+  _phase = phase;
+  if ( gWatchOut ) {
+    // watch output is written from inside the routers; keep it in order
+    for ( size_t i = 0; i < _parallel_modules.size(); ++i ) {
+      _StepModule( this, i );
+    }
+  } else {
+    _thread_pool->Run( _StepModule, this, _parallel_modules.size() );
+  }
+  for ( size_t i = 0; i < _serial_modules.size(); ++i ) {
+    switch ( phase ) {
+    case PHASE_READ_INPUTS:   _serial_modules[i]->ReadInputs( );   break;
+    case PHASE_EVALUATE:      _serial_modules[i]->Evaluate( );     break;
+    case PHASE_WRITE_OUTPUTS: _serial_modules[i]->WriteOutputs( ); break;
+    }
+  }
+}
+
 void Network::ReadInputs( )
 {
+  if ( _threads > 1 ) {
+    _ParallelStep( PHASE_READ_INPUTS );
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -190,6 +270,10 @@ void Network::ReadInputs( )
 
 void Network::Evaluate( )
 {
+  if ( _threads > 1 ) {
+    _ParallelStep( PHASE_EVALUATE );
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -199,6 +283,10 @@ void Network::Evaluate( )
 
 void Network::WriteOutputs( )
 {
+  if ( _threads > 1 ) {
+    _ParallelStep( PHASE_WRITE_OUTPUTS );
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -206,6 +294,15 @@ void Network::WriteOutputs( )
   }
 }
 
+void Network::IdleCycles( int cycles )
+{
+  for ( int r = 0; r < _size; ++r ) {
+    if ( _routers[r] ) {
+      _routers[r]->IdleCycles( cycles );
+    }
+  }
+}
+
 void Network::WriteFlit( Flit *f, int source )
 {
   assert( ( source >= 0 ) && ( source < _nodes ) );
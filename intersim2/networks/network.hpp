@@ -41,6 +41,8 @@
 #include "channel.hpp"
 #include "config_utils.hpp"
 #include "globals.hpp"
+#include "random_utils.hpp"
+#include "thread_pool.hpp"
 
 typedef Channel<Credit> CreditChannel;
 
@@ -66,6 +68,30 @@ protected:
 
   deque<TimedModule *> _timed_modules;
 
+  // ============ Parallel evaluation (network_threads > 1) ============
+  //
+  // Routers only talk to each other through channels, which already separate
+  // the value written in one phase from the one read in the next, so all
+  // routers can run a phase concurrently. Channels are cheap and run on the
+  // calling thread after the routers. Each router draws random numbers from
+  // its own stream, which makes results independent of the thread count.
+
+  enum Phase { PHASE_READ_INPUTS, PHASE_EVALUATE, PHASE_WRITE_OUTPUTS };
+
+  int _threads;
+  long _seed;
+  bool _threads_ready;
+  Phase _phase;
+  vector<TimedModule *> _parallel_modules;
+  vector<TimedModule *> _serial_modules;
+  vector<RandomStream> _streams;
+
+  static ThreadPool * _thread_pool;
+
+  void _SetupThreads( );
+  void _ParallelStep( Phase phase );
+  static void _StepModule( void * net, int index );
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
@@ -93,6 +119,7 @@ public:
   virtual void ReadInputs( );
   virtual void Evaluate( );
   virtual void WriteOutputs( );
+  void IdleCycles( int cycles );
 
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
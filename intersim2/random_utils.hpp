@@ -34,6 +34,29 @@ long   ran_next( );
 void   ranf_start(long seed);
 double ranf_next( );
 
+// Private generator for code that runs on network worker threads. While a
+// stream is selected on a thread, RandomInt() and RandomIntLong() on that
+// thread draw from it instead of the shared generator, so a module's draws do
+// not depend on how it was scheduled.
+class RandomStream {
+public:
+  RandomStream( ) : _state(0) { }
+  void Seed( unsigned long long seed ) { _state = seed; }
+  // 30 bit values, the same range as ran_next()
+  long Next( ) {
+    unsigned long long z = ( _state += 0x9E3779B97F4A7C15ULL );
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (long)( z >> 34 );
+  }
+private:
+  unsigned long long _state;
+};
+
+// selects s for the calling thread; NULL goes back to the shared generator
+void RandomSelectStream( RandomStream * s );
+
 inline void RandomSeed( long seed ) {
   ran_start( seed );
   ranf_start( seed );
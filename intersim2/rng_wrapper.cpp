@@ -28,7 +28,19 @@
 #define main rng_main
 #include "rng.c"
 
+#include "random_utils.hpp"
+
+static __thread RandomStream * _selected_stream = 0;
+
+void RandomSelectStream( RandomStream * s )
+{
+  _selected_stream = s;
+}
+
 long ran_next( )
 {
+  if ( _selected_stream ) {
+    return _selected_stream->Next( );
+  }
   return ran_arr_next( );
 }
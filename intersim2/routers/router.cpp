@@ -41,6 +41,7 @@
 #include "booksim.hpp"
 #include <iostream>
 #include <cassert>
+#include <cmath>
 #include "router.hpp"
 
 //////////////////Sub router types//////////////////////
@@ -111,6 +112,12 @@ void Router::Evaluate( )
   }
 }
 
+void Router::IdleCycles( int cycles )
+{
+  _partial_internal_cycles += cycles * _internal_speedup;
+  _partial_internal_cycles -= floor( _partial_internal_cycles );
+}
+
 void Router::OutChannelFault( int c, bool fault )
 {
   assert( ( c >= 0 ) && ( (size_t)c < _channel_faults.size( ) ) );
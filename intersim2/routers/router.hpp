@@ -114,6 +114,9 @@ public:
   virtual void ReadInputs( ) = 0;
   virtual void Evaluate( );
   virtual void WriteOutputs( ) = 0;
+  // accounts for cycles in which the router was idle and Evaluate() was
+  // not called
+  void IdleCycles( int cycles );
 
   void OutChannelFault( int c, bool fault = true );
   bool IsFaultyOutput( int c ) const;
@@ -0,0 +1,115 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt, Dongdong Li, Ali Bakhoda
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _SLAB_POOL_HPP_
+#define _SLAB_POOL_HPP_
+
+#include <vector>
+#include <cassert>
+
+using namespace std;
+
+// Free-list allocator for the small objects the network churns through every
+// cycle (flits and credits). Objects live in fixed-size slabs that are never
+// moved or freed before FreeAll(), so pointers stay valid and neighbouring
+// allocations are neighbours in memory. Every object is known by its index
+// (slab * SLAB_SIZE + offset), which T stores in an int member _index; the
+// free list is a stack of indices.
+template<class T>
+class SlabPool {
+
+public:
+  SlabPool( ) : _size(0) { }
+  ~SlabPool( ) { FreeAll( ); }
+
+  T * Allocate( ) {
+    if ( _free.empty( ) ) {
+      _Grow( );
+    }
+    T * const t = Get(_free.back( ));
+    _free.pop_back( );
+    return t;
+  }
+
+  void Release( T * t ) {
+    assert(Get(t->_index) == t);
+    _free.push_back(t->_index);
+  }
+
+  T * Get( int index ) const {
+    assert(( index >= 0 ) && ( index < _size ));
+    return &_slabs[index >> SLAB_BITS][index & ( SLAB_SIZE - 1 )];
+  }
+
+  int Outstanding( ) const { return _size - (int)_free.size( ); }
+
+  // Puts every object back on the free list in index order, so allocation
+  // walks the slabs front to back again. Only legal when nothing is
+  // outstanding; returns false (and does nothing) otherwise.
+  bool ReclaimAll( ) {
+    if ( Outstanding( ) != 0 ) {
+      return false;
+    }
+    for ( int i = 0; i < _size; ++i ) {
+      _free[i] = _size - 1 - i;
+    }
+    return true;
+  }
+
+  void FreeAll( ) {
+    for ( size_t s = 0; s < _slabs.size( ); ++s ) {
+      delete [] _slabs[s];
+    }
+    _slabs.clear( );
+    _free.clear( );
+    _size = 0;
+  }
+
+private:
+  static int const SLAB_BITS = 9;
+  static int const SLAB_SIZE = 1 << SLAB_BITS;
+
+  void _Grow( ) {
+    T * const slab = new T[SLAB_SIZE];
+    int const base = _size;
+    for ( int i = 0; i < SLAB_SIZE; ++i ) {
+      slab[i]._index = base + i;
+    }
+    _slabs.push_back(slab);
+    _size += SLAB_SIZE;
+    // lowest index on top
+    for ( int i = SLAB_SIZE - 1; i >= 0; --i ) {
+      _free.push_back(base + i);
+    }
+  }
+
+  vector<T *> _slabs;
+  vector<int> _free;
+  int _size;
+};
+
+#endif
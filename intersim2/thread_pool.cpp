@@ -0,0 +1,147 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt, Dongdong Li, Ali Bakhoda
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cassert>
+
+#include "thread_pool.hpp"
+
+// polls of the job counter before a worker goes to sleep
+static int const SPIN_LIMIT = 20000;
+
+ThreadPool::ThreadPool( int threads )
+  : _threads(threads), _task(0), _arg(0), _count(0), _next(0), _running(0),
+    _generation(0), _exit(false)
+{
+  assert(_threads >= 1);
+  pthread_mutex_init(&_lock, NULL);
+  pthread_cond_init(&_start, NULL);
+  pthread_cond_init(&_done, NULL);
+  _workers.resize(_threads - 1);
+  for ( int t = 0; t < _threads - 1; ++t ) {
+    int const err = pthread_create(&_workers[t], NULL, _WorkerMain, this);
+    assert(err == 0);
+  }
+}
+
+ThreadPool::~ThreadPool( )
+{
+  pthread_mutex_lock(&_lock);
+  _exit = true;
+  pthread_cond_broadcast(&_start);
+  pthread_mutex_unlock(&_lock);
+  for ( size_t t = 0; t < _workers.size( ); ++t ) {
+    pthread_join(_workers[t], NULL);
+  }
+  pthread_cond_destroy(&_done);
+  pthread_cond_destroy(&_start);
+  pthread_mutex_destroy(&_lock);
+}
+
+void ThreadPool::Run( Task task, void * arg, int count )
+{
+  if ( ( _threads == 1 ) || ( count <= 1 ) ) {
+    for ( int i = 0; i < count; ++i ) {
+      task(arg, i);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&_lock);
+  _task = task;
+  _arg = arg;
+  _count = count;
+  _next = 0;
+  _running = _threads - 1;
+  ++_generation;
+  pthread_cond_broadcast(&_start);
+  pthread_mutex_unlock(&_lock);
+
+  _Work( );
+
+  for ( int spin = 0; _running && ( spin < SPIN_LIMIT ); ++spin ) ;
+  if ( _running ) {
+    pthread_mutex_lock(&_lock);
+    while ( _running ) {
+      pthread_cond_wait(&_done, &_lock);
+    }
+    pthread_mutex_unlock(&_lock);
+  }
+  // make the workers' results visible to the caller
+  __sync_synchronize( );
+}
+
+void * ThreadPool::_WorkerMain( void * pool )
+{
+  static_cast<ThreadPool *>(pool)->_Worker( );
+  return NULL;
+}
+
+void ThreadPool::_Worker( )
+{
+  unsigned seen = 0;
+  while ( true ) {
+    for ( int spin = 0; ( _generation == seen ) && !_exit && ( spin < SPIN_LIMIT ); ++spin ) ;
+    if ( ( _generation == seen ) && !_exit ) {
+      pthread_mutex_lock(&_lock);
+      while ( ( _generation == seen ) && !_exit ) {
+        pthread_cond_wait(&_start, &_lock);
+      }
+      pthread_mutex_unlock(&_lock);
+    }
+    if ( _exit ) {
+      return;
+    }
+    // pick up the job description published before _generation was bumped
+    __sync_synchronize( );
+    seen = _generation;
+
+    _Work( );
+
+    if ( __sync_sub_and_fetch(&_running, 1) == 0 ) {
+      pthread_mutex_lock(&_lock);
+      pthread_cond_signal(&_done);
+      pthread_mutex_unlock(&_lock);
+    }
+  }
+}
+
+// indices are claimed in chunks so that threads do not contend on _next for
+// every router
+void ThreadPool::_Work( )
+{
+  int chunk = _count / ( 4 * _threads );
+  if ( chunk < 1 ) {
+    chunk = 1;
+  }
+  int begin;
+  while ( ( begin = __sync_fetch_and_add(&_next, chunk) ) < _count ) {
+    int const end = ( begin + chunk < _count ) ? ( begin + chunk ) : _count;
+    for ( int i = begin; i < end; ++i ) {
+      _task(_arg, i);
+    }
+  }
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2009-2013, Tor M. Aamodt, Dongdong Li, Ali Bakhoda
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <pthread.h>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads that run an indexed task in parallel with the
+// calling thread. Used by Network to evaluate its routers concurrently; the
+// workers spin briefly between jobs and then sleep, so back-to-back phases
+// within a cycle do not pay for a wakeup each time.
+class ThreadPool {
+
+public:
+  typedef void (*Task)( void * arg, int index );
+
+  // threads counts the calling thread, so ThreadPool(1) runs everything inline
+  ThreadPool( int threads );
+  ~ThreadPool( );
+
+  int NumThreads( ) const { return _threads; }
+
+  // calls task(arg, i) once for every i in [0, count) and returns when all
+  // calls have finished; indices are handed out dynamically, so tasks must
+  // not depend on which thread runs them or in what order
+  void Run( Task task, void * arg, int count );
+
+private:
+  static void * _WorkerMain( void * pool );
+  void _Worker( );
+  void _Work( );
+
+  int _threads;
+  vector<pthread_t> _workers;
+
+  pthread_mutex_t _lock;
+  pthread_cond_t _start;
+  pthread_cond_t _done;
+
+  Task _task;
+  void * _arg;
+  int _count;
+  volatile int _next;             // next index to hand out
+  volatile int _running;          // workers that have not finished the current job
+  volatile unsigned _generation;  // bumped for every job
+  volatile bool _exit;
+};
+
+#endif
@@ -286,6 +286,8 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _measured_in_flight_flits.resize(_classes);
     _retired_packets.resize(_classes);
 
+    _step_flits.assign(_subnets * _nodes, NULL);
+
     _packet_seq_no.resize(_nodes);
     _repliesPending.resize(_nodes);
     _requestsOutstanding.resize(_nodes);
@@ -679,10 +681,8 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         if(f->head) {
             head = f;
         } else {
-            map<int, Flit *>::iterator iter = _retired_packets[f->cl].find(f->pid);
-            assert(iter != _retired_packets[f->cl].end());
-            head = iter->second;
-            _retired_packets[f->cl].erase(iter);
+            head = _retired_packets[f->cl].Remove(f->pid);
+            assert(head);
             assert(head->head);
             assert(f->pid == head->pid);
         }
@@ -741,7 +741,7 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
     }
   
     if(f->head && !f->tail) {
-        _retired_packets[f->cl].insert(make_pair(f->pid, f));
+        _retired_packets[f->cl].Insert(f->pid, f);
     } else {
         f->Free();
     }
@@ -958,8 +958,6 @@ void TrafficManager::_Step( )
         cout << "WARNING: Possible network deadlock.\n";
     }
 
-    vector<map<int, Flit *> > flits(_subnets);
-  
     for ( int subnet = 0; subnet < _subnets; ++subnet ) {
         for ( int n = 0; n < _nodes; ++n ) {
             Flit * const f = _net[subnet]->ReadFlit( n );
@@ -972,7 +970,7 @@ void TrafficManager::_Step( )
                                << " from VC " << f->vc
                                << "." << endl;
                 }
-                flits[subnet].insert(make_pair(n, f));
+                _step_flits[subnet * _nodes + n] = f;
                 if((_sim_state == warming_up) || (_sim_state == running)) {
                     ++_accepted_flits[f->cl][n];
                     if(f->tail) {
@@ -1234,9 +1232,9 @@ void TrafficManager::_Step( )
 
     for(int subnet = 0; subnet < _subnets; ++subnet) {
         for(int n = 0; n < _nodes; ++n) {
-            map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-            if(iter != flits[subnet].end()) {
-                Flit * const f = iter->second;
+            Flit * const f = _step_flits[subnet * _nodes + n];
+            if(f) {
+                _step_flits[subnet * _nodes + n] = NULL;
 
                 f->atime = _time;
                 if(f->watch) {
@@ -1257,7 +1255,6 @@ void TrafficManager::_Step( )
                 _RetireFlit(f, n);
             }
         }
-        flits[subnet].clear();
         _net[subnet]->Evaluate( );
         _net[subnet]->WriteOutputs( );
     }
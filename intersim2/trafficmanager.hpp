@@ -47,6 +47,89 @@
 //register the requests to a node
 class PacketReplyInfo;
 
+// Head flits of packets whose tail has not been retired yet, keyed by packet
+// id. Open addressing with linear probing and backward shift deletion; the
+// table only grows, so once it has seen the peak number of partially retired
+// packets no further allocation happens.
+class PacketTable {
+public:
+  PacketTable( ) : _mask(15), _size(0), _slots(16) { }
+
+  void Insert( int pid, Flit *f ) {
+    assert(f);
+    if ( 2 * ( _size + 1 ) > _slots.size( ) ) {
+      _Grow( );
+    }
+    unsigned i = _Hash(pid);
+    while ( _slots[i].f ) {
+      assert(_slots[i].pid != pid);
+      i = ( i + 1 ) & _mask;
+    }
+    _slots[i].pid = pid;
+    _slots[i].f = f;
+    ++_size;
+  }
+
+  // returns NULL if pid is not in the table
+  Flit * Remove( int pid ) {
+    unsigned i = _Hash(pid);
+    while ( _slots[i].f && _slots[i].pid != pid ) {
+      i = ( i + 1 ) & _mask;
+    }
+    Flit * const f = _slots[i].f;
+    if ( !f ) {
+      return NULL;
+    }
+    // pull later entries of the probe run back so lookups never stop early
+    unsigned j = i;
+    while ( true ) {
+      j = ( j + 1 ) & _mask;
+      if ( !_slots[j].f ) {
+        break;
+      }
+      unsigned const home = _Hash(_slots[j].pid);
+      if ( ( ( j - home ) & _mask ) >= ( ( j - i ) & _mask ) ) {
+        _slots[i] = _slots[j];
+        i = j;
+      }
+    }
+    _slots[i].f = NULL;
+    --_size;
+    return f;
+  }
+
+  bool Empty( ) const { return _size == 0; }
+  size_t Size( ) const { return _size; }
+
+private:
+  struct Slot {
+    int pid;
+    Flit *f;
+    Slot( ) : pid(-1), f(NULL) { }
+  };
+
+  unsigned _Hash( int pid ) const {
+    return ( (unsigned)pid * 0x9E3779B1u ) & _mask;
+  }
+
+  void _Grow( ) {
+    vector<Slot> old;
+    old.swap(_slots);
+    _slots.resize(2 * old.size( ));
+    _mask = _slots.size( ) - 1;
+    _size = 0;
+    for ( size_t k = 0; k < old.size( ); ++k ) {
+      if ( old[k].f ) {
+        Insert(old[k].pid, old[k].f);
+      }
+    }
+  }
+
+  unsigned _mask;
+  size_t _size;
+  vector<Slot> _slots;
+};
+
 class TrafficManager : public Module {
 
 private:
@@ -115,7 +198,7 @@ protected:
 
   vector<map<int, Flit *> > _total_in_flight_flits;
   vector<map<int, Flit *> > _measured_in_flight_flits;
-  vector<map<int, Flit *> > _retired_packets;
+  vector<PacketTable> _retired_packets;
   bool _empty_network;
 
   bool _hold_switch_for_packet;
@@ -124,6 +207,10 @@ protected:
 
   int _subnets;
 
+  // flits ejected this cycle, indexed by subnet * _nodes + node; entries are
+  // cleared again before _Step returns
+  vector<Flit *> _step_flits;
+
   vector<int> _subnet;
 
   // ============ deadlock ==========
@@ -156,7 +156,10 @@ void stream_operation::do_operation( gpgpu_sim *gpu )
         	printf("kernel \'%s\' transfer to GPU hardware scheduler\n", m_kernel->name().c_str() );
             if( m_sim_mode )
                 gpgpu_cuda_ptx_sim_main_func( *m_kernel );
-            else
+            else if( gpu->begin_fast_forward() ) {
+                gpgpu_cuda_ptx_sim_main_func( *m_kernel );
+                gpu->end_fast_forward();
+            } else
                 gpu->launch( m_kernel );
         }
         break;